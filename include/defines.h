@@ -9,11 +9,114 @@
 #define PETSCIIMAP          0x0347      // PETSCII map in cassette/RS232 buffer
 #define COLORMEMORY         0x0800      // Color memory base address
 #define SCREENMEMORY        0x0C00      // Screen memory base address
-#define WINDOWBASEADDRESS   0xB000      // Base address for windows system data, 8k reserved
-#define CHARSET             0xB800      // Base address for redefined charset
-#define SCREENMAPBASE       0xC000      // Base address for screen map
+#define OVERLAYBASE         0x9000      // Base address for code overlays, should match __OVERLAYSTART__ in tedse-cc65config.cfg
+#define WINDOWBASEADDRESS   0xA000      // Base address for windows system data, 2k reserved
+#define CHARSET             0xA800      // Base address for redefined charset
+#define SCREENMAPBASE       0xAC00      // Base address for screen map
+#define HELPSCREENSIZE      0x0800      // Size of help screen data from color memory start
 #define MEMORYLIMIT         0xFCFF      // Upper memory limit address for address map
 
+/* Flood fill work area, shares the window area as fill only runs from main mode without open windows */
+#define FILLROWTABLE        0xA000      // Row pointers to character data of screen map
+#define FILLMAXROWS         264         // Maximum rows in row pointer table, above maximum canvas height
+#define FILLSTACK           0xA210      // Span seed stack directly after row pointer table
+#define FILLSTACKSIZE       380         // Number of seeds on span stack, fills up the 2k window area
+#define FILL_SCREENCODE     1           // Fill mode flag: match and replace screencode
+#define FILL_ATTRIBUTE      2           // Fill mode flag: match and replace attribute
+
+/* Asset bundle entry numbers, in order of the bundle build in the Makefile */
+#define ASSET_TITLESCREEN   0           // Title screen
+#define ASSET_PETSCIIMAP    1           // Visual PETSCII map
+#define ASSET_HELPSCREEN    2           // First of four help screens
+
+/* Compressed screen file header */
+#define SCRN_LFN            2           // Logical file number for screen file streaming
+#define SCRN_HEADERSIZE     12          // Header size: magic, version, width, height, colors and checksum
+#define SCRN_MAGIC0         0x54        // 'T'
+#define SCRN_MAGIC1         0x53        // 'S'
+#define SCRN_MAGIC2         0x5A        // 'Z'
+#define SCRN_VERSION        2           // Format version: RLE packed data follows header
+#define SCRNFILE_INVALID    0           // Screen file could not be opened or has unsupported version
+#define SCRNFILE_RAW        1           // Screen file without header, as saved by older versions
+#define SCRNFILE_COMPRESSED 2           // Compressed screen file with header
+
+/* Project container file header */
+#define PROJ_METASIZE       21          // Size of project metadata, also the size of a .proj file of older versions
+#define PROJ_HEADERSIZE     27          // Header size: three magic bytes, format version, metadata and checksum
+#define PROJ_MAGIC0         0x54        // 'T'
+#define PROJ_MAGIC1         0x53        // 'S'
+#define PROJ_MAGIC2         0x50        // 'P'
+#define PROJ_VERSION        2           // Format version: charset if changed and RLE packed screen follow header
+#define PROJ_CHECKSUM       25          // Offset in header of checksum over charset if changed and unpacked screen
+#define PROJ_CHECKSUMERROR  254         // Error code for a project of which the checksum does not match
+#define PROJ_TEMPNAME       "tedse.tmp" // Name a project is written under, renamed to the project name when complete
+
+/* Region file header */
+#define REGN_HEADERSIZE     8           // Header size: magic, version, width and height
+#define REGN_MAGIC0         0x54        // 'T'
+#define REGN_MAGIC1         0x53        // 'S'
+#define REGN_MAGIC2         0x52        // 'R'
+#define REGN_VERSION        1           // Format version: per row attribute and character data follow header
+
+/* Directory cache */
+#define DIRCACHE_LFN        3           // Logical file number for reading the directory
+#define DIRCACHE_ENTRIES    64          // Maximum number of cached directory entries per device
+#define DIRCACHE_SLOTS      4           // Number of devices with a cached directory: 8-11 each have their own, higher ids share
+#define DIRPICK_ROWS        8           // Number of entries shown at once in the directory picker
+
+/* Autosave journal file */
+#define JRNL_NAME           "tedse.jrnl"    // Journal filename, one journal per disk
+#define JRNL_HEADERSIZE     24          // Header size: magic, version, width, height and base filename
+#define JRNL_MAGIC0         0x54        // 'T'
+#define JRNL_MAGIC1         0x53        // 'S'
+#define JRNL_MAGIC2         0x4A        // 'J'
+#define JRNL_VERSION        1           // Format version: records of row number, attribute and character data follow header
+#define JRNL_INTERVAL       120         // Minimum number of seconds between autosaves
+#define DIRTYROWS_SIZE      ((FILLMAXROWS+7)/8) // Bytes in modified rows bitmap
+
+/* PETSCII SEQ import and export */
+#define SEQ_BLOCKSIZE       256         // Size of block read or written at once
+#define PETSCII_RETURN      13
+#define PETSCII_LOWERCASE   14
+#define PETSCII_DOWN        17
+#define PETSCII_RVSON       18
+#define PETSCII_HOME        19
+#define PETSCII_DELETE      20
+#define PETSCII_RIGHT       29
+#define PETSCII_QUOTE       34
+#define PETSCII_FLASHON     130
+#define PETSCII_FLASHOFF    132
+#define PETSCII_SHIFTRETURN 141
+#define PETSCII_UPPERCASE   142
+#define PETSCII_UP          145
+#define PETSCII_RVSOFF      146
+#define PETSCII_CLEAR       147
+#define PETSCII_INSERT      148
+#define PETSCII_LEFT        157
+
+/* Data export for own programs, decoders in tools/tedsedecode.s */
+#define EXPORT_RAW          0           // Bytes as in memory
+#define EXPORT_RLE          1           // RLE packed in blocks as TED_RLE_Write()
+#define EXPORT_TILES        2           // Map of 2x2 tiles followed by tile table
+#define EXPORT_MAXTILES     256         // Maximum number of tiles per plane
+#define EXPORT_TILEERROR    254         // Error code for more tiles than fit
+#define EXPORT_MEMORYERROR  253         // Error code for no memory for the tile table
+
+/* Overlay numbers */
+#define OVERLAY_CHAREDIT    1           // Character editor
+#define OVERLAY_FILE        2           // Screen and charset load and save
+#define OVERLAY_RESIZE      3           // Resize width and height
+#define OVERLAY_SEQEXPORT   4           // PETSCII SEQ export
+#define OVERLAY_PROJECT     5           // Project load and save
+#define OVERLAY_REGION      6           // Region load and save
+#define OVERLAY_COLORS      7           // Background and border color pickers
+#define OVERLAY_FILL        8           // Flood fill mode
+#define OVERLAY_INFO        9           // Screen and version info
+#define OVERLAY_DATAEXPORT  10          // Data export
+#define OVERLAY_WRITE       11          // Write mode and PETSCII SEQ import
+#define OVERLAY_DRAW        12          // Line and box, move and select modes
+#define OVERLAY_PALETTE     13          // Palette and color write modes
+
 /* Global variables */
 extern unsigned char overlay_active;
 
@@ -25,6 +128,27 @@ struct WindowStruct
     unsigned char height;
 };
 extern struct WindowStruct Window[9];
+
+//Flood fill data
+struct FillSeed
+{
+    unsigned int x;
+    unsigned int y;
+};
+//Directory cache entry
+struct DirEntry
+{
+    char name[17];
+    unsigned char type;
+};
+//Cached directory of a device
+struct DirCache
+{
+    unsigned char device;               // Device id of the cached directory, 0 if not read
+    unsigned char count;                // Number of cached entries
+    unsigned char complete;             // 1 if all entries fit in the cache
+    struct DirEntry* entry;             // Entries, allocated on first read
+};
 extern unsigned int windowaddress;
 extern unsigned char windownumber;
 
@@ -34,7 +158,7 @@ extern unsigned char pulldownmenunumber;
 extern char menubartitles[4][12];
 extern unsigned char menubarcoords[4];
 extern unsigned char pulldownmenuoptions[5];
-extern char pulldownmenutitles[5][6][17];
+extern char pulldownmenutitles[5][8][17];
 
 // Menucolors
 extern unsigned char mc_mb_normal;
@@ -61,6 +185,9 @@ extern unsigned int yoffset;
 extern unsigned int screenwidth;
 extern unsigned int screenheight;
 extern unsigned int screentotal;
+extern unsigned int screenstride;
+extern unsigned int screenplane;
+extern unsigned char screenalign;
 extern unsigned char screenbackground;
 extern unsigned char screenborder;
 extern unsigned char plotscreencode;
@@ -73,6 +200,7 @@ extern unsigned char colsel;
 extern unsigned char palettechar;
 extern unsigned char visualmap;
 extern unsigned char favourites[10];
+extern unsigned char* helpcache[4];
 
 extern char buffer[81];
 extern char version[22];
@@ -1,7 +1,7 @@
 #ifndef __PRGGENERATOR_H_
 #define __PRGGENERATOR_H_
 
-#define ASS_SIZE        0x0143
+#define ASS_SIZE        0x05E1
 #define SCREEN_SIZE     0x0800
 #define CHAR_SIZE       0x0400
 
@@ -12,6 +12,45 @@
 #define BORDERCOLORADDR 0x107C
 #define CHARSET_ADDRESS 0x107D
 #define CHARSET_LOWER   0x107F
-#define SCREENSTART     0x113E
+#define MAPWIDTH_ADDR   0x1084
+#define MAPMAXX_ADDR    0x1086
+#define MAPMAXY_ADDR    0x1088
+#define MAPPLANE_ADDR   0x108A
+#define CHARSET_DEST    0x108C
+#define MAPADDRESS      0x108D
+#define PACKEDSIZE_ADDR 0x108F
+#define PACKEDTOP_ADDR  0x1091
+#define SCREENBASE_ADDR 0x1093
+#define FRAMECOUNT_ADDR 0x1094
+#define FRAMEDELAY_ADDR 0x1095
+#define FRAMES_ADDR     0x1096
+#define BUFFER1_ADDR    0x1098
+#define BUFFER2_ADDR    0x1099
+
+#define CALL_SIZE       0x016C
+#define CALL_BLOCKLO    0x100E
+#define CALL_BLOCKHI    0x1012
+#define CALL_BLOCK      0x1162
+#define CALL_SCREEN     0x1162
+#define CALL_CHARSET    0x1163
+#define CALL_LOWER      0x1164
+#define CALL_BGCOLOR    0x1165
+#define CALL_BORDER     0x1166
+
+#define CHARSET_COPY    0x3000
+#define GENERATORBASE   0x8000
+
+#define TED_CONTROL1    0xFF06
+
+#define RLE_END         0xFF
+#define RLE_MAXCOUNT    128
+#define RLE_STREAMBLOCK 256
+#define CHARSET_RESERVE (CHAR_SIZE+CHAR_SIZE/RLE_MAXCOUNT+2)
+
+#define PACK_MEASURE    0
+#define PACK_FILE       1
+#define PACK_MEMORY     2
+
+#define MAXSLIDES       32
 
 #endif // __PRGGENERATOR_H_
\ No newline at end of file
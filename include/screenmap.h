@@ -0,0 +1,60 @@
+#ifndef __SCREENMAP_H_
+#define __SCREENMAP_H_
+
+/* Memory access for the screen map routines in screenmap.c.
+   With cc65 these access Plus/4 memory directly. Built with a host compiler,
+   as tools/tedsemapbench does, memory is the 64K array hostmemory and the
+   flood fill work area lives in host arrays, as host integers are wider. */
+#ifdef __CC65__
+#include <peekpoke.h>
+#define MEMORY(address)         ((unsigned char*)(address))
+#define FILLROWPOINTERS         ((unsigned int*)FILLROWTABLE)
+#define FILLSEEDS               ((struct FillSeed*)FILLSTACK)
+#else
+extern unsigned char hostmemory[0x10000];
+extern unsigned int hostfillrows[FILLMAXROWS];
+extern struct FillSeed hostfillstack[FILLSTACKSIZE];
+#define PEEK(address)           (hostmemory[(address)])
+#define POKE(address,value)     (hostmemory[(address)] = (value))
+#define MEMORY(address)         (hostmemory+(address))
+#define FILLROWPOINTERS         hostfillrows
+#define FILLSEEDS               hostfillstack
+#define TED_BlankProgress()
+#define COLOR_WHITE             0x71        // As in plus4.h of cc65
+#endif
+
+/* Screen map state, defined in screenmap.c */
+extern unsigned int screenwidth;
+extern unsigned int screenheight;
+extern unsigned int screentotal;
+extern unsigned int screenstride;
+extern unsigned int screenplane;
+extern unsigned char screenalign;
+extern unsigned char dirtyrows[DIRTYROWS_SIZE];
+extern unsigned char dirtyrows_any;
+
+/* Program version for the signature, defined in main.c */
+extern char version[22];
+
+/* Function declarations */
+void dirtyrows_mark(unsigned int row, unsigned int count);
+unsigned int screenmap_screenaddr(unsigned int row, unsigned int col);
+unsigned int screenmap_attraddr(unsigned int row, unsigned int col);
+unsigned int screenmap_packedscreenaddr(unsigned int row, unsigned int col, unsigned int width, unsigned int height);
+unsigned int screenmap_packedattraddr(unsigned int row, unsigned int col, unsigned int width);
+void screenmapplot(unsigned int row, unsigned int col, unsigned char screencode, unsigned char attribute);
+void placesignature();
+void screenmapfill(unsigned char screencode, unsigned char attribute);
+unsigned int screenmap_alignedstride(unsigned int width);
+unsigned int screenmap_alignedsize(unsigned int width, unsigned int height);
+unsigned char screenmap_fits(unsigned int width, unsigned int height);
+unsigned char screenmap_setlayout(unsigned char aligned);
+void screenmap_copyarea(unsigned int row, unsigned int col, unsigned int destrow, unsigned int destcol, unsigned int width, unsigned int height, unsigned char cut);
+void screenmap_fillarea(unsigned int row, unsigned int col, unsigned int width, unsigned int height, unsigned char screencode, unsigned char attribute, unsigned char mode);
+void screenmap_paintarea(unsigned int row, unsigned int col, unsigned int width, unsigned int height, unsigned char color);
+void screenmap_resizewidth(unsigned int newwidth);
+void screenmap_resizeheight(unsigned int newheight);
+unsigned char screenmap_fillchanges(unsigned int x, unsigned int y, unsigned char mode, unsigned char newcode, unsigned char newattr);
+unsigned char screenmap_floodfill(unsigned int x, unsigned int y, unsigned char mode, unsigned char newcode, unsigned char newattr);
+
+#endif
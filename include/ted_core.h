@@ -15,6 +15,19 @@
 // TED control addresses
 #define TED_RAMSELECT       0xff12      // TED data fetch ROM/RAM select (on bit 2)
 #define TED_CHARBASE        0xff13      // TED Character data base address (ob bit 2-7)
+#define TED_CONTROL1        0xff06      // TED control register 1, display enable on bit 4
+#define TED_BORDERCOLOR     0xff19      // TED border color and luminance
+
+// Defines for blanking the display during heavy operations
+#define BLANK_OFF               0           // Never blank
+#define BLANK_ON                1           // Blank display
+#define BLANK_PROGRESS          2           // Blank display and cycle border color as progress indicator
+
+// Defines for RLE packed data
+#define RLE_END                 0xff        // End of packed data marker
+#define RLE_MAXCOUNT            128         // Maximum length of a literal or a run
+#define RLE_WORSTCASE(x)        ((x)+((x)/RLE_MAXCOUNT)+2)  // Maximum packed size for given unpacked size
+#define RLE_STREAMBLOCK         256         // Block size for packing to and unpacking from files
 
 // Defines for scroll directions
 #define SCROLL_LEFT             0x01
@@ -33,12 +46,15 @@ extern unsigned char TED_tmp1;
 extern unsigned char TED_tmp2;
 extern unsigned char TED_tmp3;
 extern unsigned char TED_tmp4;
+extern unsigned char TED_blankmode;
+extern clock_t TED_blanktime;
 
 // Import assembly core Functions
 void TED_HChar_core();
 void TED_VChar_core();
 void TED_FillArea_core();
 void TED_CopyViewPortToTED_core();
+void TED_CopyViewPortToTED_paged_core();
 void TED_ScrollCopy_core();
 void TED_Scroll_right_core();
 void TED_Scroll_left_core();
@@ -46,6 +62,8 @@ void TED_Scroll_down_core();
 void TED_Scroll_up_core();
 void TED_ROM_Peek_core();
 void TED_ROM_Memcopy_core();
+void TED_RLE_Unpack_core();
+void TED_Checksum_core();
 
 // Function Prototypes
 void TED_HChar(unsigned char row, unsigned char col, unsigned char character, unsigned char length, unsigned char attribute);
@@ -56,17 +74,25 @@ void TED_Exit(void);
 unsigned char TED_PetsciiToScreenCode(unsigned char p);
 unsigned char TED_PetsciiToScreenCodeRvs(unsigned char p);
 unsigned int TED_RowColToAddress(unsigned char row, unsigned char col);
+void TED_BlankStart(void);
+void TED_BlankProgress(void);
+void TED_BlankEnd(unsigned char border);
 unsigned int TED_Load(char* filename, unsigned char deviceid, unsigned int destination);
 unsigned char TED_Save(char* filename, unsigned char deviceid, unsigned int source, unsigned int length);
 unsigned char TED_Attribute(unsigned char color, unsigned char luminance, unsigned char blink);
 void TED_Plot(unsigned char row, unsigned char col, unsigned char screencode, unsigned char attribute);
 void TED_PlotString(unsigned char row, unsigned char col, char* plotstring, unsigned char length, unsigned char attribute);
-void TED_CopyViewPortToTED(unsigned int sourcebase, unsigned int sourcewidth, unsigned int sourceheight, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight );
-void TED_ScrollCopy(unsigned int sourcebase, unsigned int sourcewidth, unsigned int sourceheight, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight, unsigned char direction);
+void TED_CopyViewPortToTED(unsigned int sourcebase, unsigned int sourcestride, unsigned int sourceplane, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight );
+void TED_ScrollCopy(unsigned int sourcebase, unsigned int sourcestride, unsigned int sourceplane, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight, unsigned char direction);
 void TED_ScrollMove(unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight, unsigned char direction, unsigned char clear);
 void TED_CharsetCustom(unsigned int charsetaddress);
 void TED_CharsetStandard(unsigned char lowercaseflag);
 unsigned char TED_ROM_Peek(unsigned int address);
 void TED_ROM_Memcopy(unsigned int source, unsigned int destination, unsigned char pages);
+unsigned int TED_RLE_Pack(unsigned int source, unsigned int destination, unsigned int length);
+unsigned int TED_RLE_Unpack(unsigned int source, unsigned int destination);
+unsigned char TED_RLE_Write(unsigned char lfn, unsigned int source, unsigned int length);
+unsigned int TED_RLE_Read(unsigned char lfn, unsigned int destination, unsigned int limit);
+unsigned int TED_Checksum(unsigned int source, unsigned int length);
 
 #endif
\ No newline at end of file
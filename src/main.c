@@ -50,8 +50,10 @@ BUT WITHOUT ANY WARRANTY. USE THEM AT YOUR OWN RISK!
 #include <ctype.h>
 #include <device.h>
 #include <plus4.h>
+#include <time.h>
 #include "defines.h"
 #include "ted_core.h"
+#include "screenmap.h"
 
 //Window data
 struct WindowStruct Window[9];
@@ -63,21 +65,28 @@ unsigned char menubaroptions = 4;
 unsigned char pulldownmenunumber = 8;
 char menubartitles[4][12] = {"screen","file","charset","information"};
 unsigned char menubarcoords[4] = {1,8,13,21};
-unsigned char pulldownmenuoptions[5] = {6,4,2,2,2};
-char pulldownmenutitles[5][6][17] = {
+unsigned char pulldownmenuoptions[5] = {7,8,2,4,2};
+char pulldownmenutitles[5][8][17] = {
     {"width:       40 ",
      "height:      25 ",
      "background:   0 ",
      "border:       0 ",
      "clear           ",
-     "fill            "},
+     "fill            ",
+     "layout:  packed "},
     {"save screen     ",
      "load screen     ",
      "save project    ",
-     "load project    "},
+     "load project    ",
+     "load region     ",
+     "autosave:   off ",
+     "export seq      ",
+     "export data     "},
     {"load charset    ",
      "save charset    "},
-    {"version/credits ",
+    {"screen info     ",
+     "version/credits ",
+     "blank:       off",
      "exit program    "},
     {"yes",
      "no "}
@@ -91,6 +100,7 @@ unsigned char mc_pd_select = COLOR_YELLOW;
 unsigned char mc_menupopup = COLOR_WHITE;
 
 // Global variables
+unsigned char overlay_active = 0;
 unsigned char bootdevice;
 char DOSstatus[40];
 unsigned char charsetchanged;
@@ -105,9 +115,6 @@ unsigned char screen_col;
 unsigned char screen_row;
 unsigned int xoffset;
 unsigned int yoffset;
-unsigned int screenwidth;
-unsigned int screenheight;
-unsigned int screentotal;
 unsigned char screenbackground;
 unsigned char screenborder;
 unsigned char plotscreencode;
@@ -120,6 +127,21 @@ unsigned char colsel = 0;
 unsigned char palettechar;
 unsigned char visualmap = 0;
 unsigned char favourites[10];
+unsigned char* helpcache[4];
+struct DirCache dircache[DIRCACHE_SLOTS];
+unsigned char autosave = 0;
+char journalbase[17];
+unsigned char journaldevice;
+unsigned char journalstarted;
+clock_t journaltime;
+unsigned char seqblock[SEQ_BLOCKSIZE];
+unsigned int seqpos;
+unsigned char seqerror;
+unsigned char seqrvs;
+unsigned char seqcolor;
+unsigned char seqflash;
+unsigned char exportasm;
+unsigned char exportcount;
 
 char buffer[81];
 char version[22];
@@ -184,6 +206,7 @@ int textInput(unsigned char xpos, unsigned char ypos, char* str, unsigned char s
     * @param[in,out] str string that is edited, it can have content and must have at least @p size + 1 bytes. Maximum size     if 255 bytes.
     * @param[in] size maximum length of @p str in bytes.
     * @return -1 if input was aborted.
+    * @return -2 if the directory was requested with F3.
     * @return >= 0 length of edited string @p str.
     */
 
@@ -204,6 +227,10 @@ int textInput(unsigned char xpos, unsigned char ypos, char* str, unsigned char s
             cursor(0);
             return -1;
 
+        case CH_F3:
+            cursor(0);
+            return -2;
+
         case CH_ENTER:
             idx = strlen(str);
             str[idx] = 0;
@@ -360,7 +387,7 @@ void initstatusbar()
 
 void hidestatusbar()
 {
-    TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset+24,0,24,40,1);
+    TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset+24,0,24,40,1);
 }
 
 void togglestatusbar()
@@ -695,58 +722,491 @@ void messagepopup(char* message, unsigned char syscharset)
     textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));  
 }
 
-// Generic screen map routines
+void loadoverlay(unsigned char overlay_select)
+{
+    // Load memory overlay with given number from the boot device
+    // Input: number of overlay to load
+
+    // Return if overlay already active
+    if(overlay_select == overlay_active) { return; }
+
+    // Invalidate present overlay as a failed load can leave it partially overwritten
+    overlay_active = 0;
+
+    sprintf(buffer,"tedse.ovl%u",overlay_select);
+
+    while(TED_Load(buffer,bootdevice,OVERLAYBASE)<=OVERLAYBASE)
+    {
+        messagepopup("insert application disk.",0);
+    }
+
+    overlay_active = overlay_select;
+}
+
+// File dialog and directory cache routines, resident as the file, project, region and export overlays use them
 
-unsigned int screenmap_screenaddr(unsigned char row, unsigned char col, unsigned int width, unsigned int height)
+struct DirCache* dircache_slot(unsigned char device)
 {
-    // Function to calculate screenmap address for the character space
-    // Input: row, col, width and height for screenmap
+    // Cache slot of a device, devices 8-11 each have their own slot
+    // Input: device id
 
-    return SCREENMAPBASE+(row*width)+col+(width*height)+24;
+    return &dircache[(device-8) & (DIRCACHE_SLOTS-1)];
 }
 
-unsigned int screenmap_attraddr(unsigned char row, unsigned char col, unsigned int width)
+void dircache_invalidate(unsigned char device)
 {
-    // Function to calculate screenmap address for the attribute space
-    // Input: row, col, width and height for screenmap
-    return SCREENMAPBASE+(row*width)+col;
+    // Discard the cached directory of a device, it is read again on next use
+    // Input: device id
+
+    struct DirCache* cache = dircache_slot(device);
+
+    if(cache->device == device) { cache->device = 0; }
 }
 
-void screenmapplot(unsigned char row, unsigned char col, unsigned char screencode, unsigned char attribute)
+struct DirCache* dircache_read(unsigned char device)
 {
-    // Function to plot a screencodes at bank 1 memory screen map
-	// Input: row and column, screencode to plot, attribute code
+    // Read the directory of a device to its cache, unless it is already cached
+    // Input: device id
+    // Output: cache holding the directory of the device, NULL if not available
+
+    struct cbm_dirent direntry;
+    struct DirCache* cache = dircache_slot(device);
 
-    POKE(screenmap_screenaddr(row,col,screenwidth,screenheight),screencode);
-    POKE(screenmap_attraddr(row,col,screenwidth),attribute);
+    if(cache->device == device) { return cache; }
+
+    if(!cache->entry)
+    {
+        cache->entry = malloc(DIRCACHE_ENTRIES*sizeof(struct DirEntry));
+        if(!cache->entry) { return NULL; }
+    }
+
+    cache->device = 0;
+    cache->count = 0;
+    cache->complete = 1;
+
+    if(cbm_opendir(DIRCACHE_LFN,device,"$")) { return NULL; }
+
+    while(!cbm_readdir(DIRCACHE_LFN,&direntry))
+    {
+        // Skip disk name line
+        if(direntry.type == CBM_T_HEADER) { continue; }
+
+        // Entries that do not fit make the cache incomplete
+        if(cache->count == DIRCACHE_ENTRIES)
+        {
+            cache->complete = 0;
+            break;
+        }
+        strcpy(cache->entry[cache->count].name,direntry.name);
+        cache->entry[cache->count++].type = direntry.type;
+    }
+    cbm_closedir(DIRCACHE_LFN);
+
+    cache->device = device;
+    return cache;
 }
 
-void placesignature()
+int dircache_find(struct DirCache* cache, char* name)
 {
-    // Place signature in screenmap with program version
+    // Search a filename in a cached directory
+    // Input: cache, filename
+    // Output: number of the entry, -1 if not found
 
-    char versiontext[25] = "";
     unsigned char x;
-    unsigned int address = SCREENMAPBASE + (screenwidth*screenheight);
 
-    sprintf(versiontext," %s ",version);
+    for(x=0;x<cache->count;x++)
+    {
+        if(!strcmp(cache->entry[x].name,name)) { return x; }
+    }
+    return -1;
+}
+
+void dircache_saved(char* name, unsigned char type, unsigned char error)
+{
+    // Update the cached directory of the target device after a save
+    // Input: saved filename, CBM file type, error code of the save
+
+    struct DirCache* cache = dircache_slot(targetdevice);
+
+    // A failed save can leave the old file scratched, so read the directory again on next use
+    if(error)
+    {
+        dircache_invalidate(targetdevice);
+        return;
+    }
+
+    if(cache->device != targetdevice || dircache_find(cache,name) != -1) { return; }
+
+    if(cache->count == DIRCACHE_ENTRIES)
+    {
+        cache->complete = 0;
+        return;
+    }
+    strcpy(cache->entry[cache->count].name,name);
+    cache->entry[cache->count++].type = type;
+}
+
+void dircache_remove(char* name, unsigned char device)
+{
+    // Remove a scratched file from the cached directory of a device
+    // Input: filename, device id
+
+    struct DirCache* cache = dircache_slot(device);
+    int entry;
 
-    for(x=0;x<strlen(versiontext);x++)
+    if(cache->device != device) { return; }
+
+    entry = dircache_find(cache,name);
+    if(entry != -1)
     {
-        POKE(address+x,versiontext[x]);
+        cache->entry[entry] = cache->entry[--cache->count];
     }
 }
 
-void screenmapfill(unsigned char screencode, unsigned char attribute)
+unsigned char dirpicker(char* suffix, unsigned char maxlen)
+{
+    // Present the cached directory of the target device to pick a filename
+    // Input: suffix to filter on and strip from the picked name (empty for all files), maximum filename length
+    // Output: 1 if a name is picked and copied to filename, 0 if cancelled
+
+    struct DirCache* cache = NULL;
+    unsigned char index[DIRCACHE_ENTRIES];
+    unsigned char count = 0;
+    unsigned char top = 0;
+    unsigned char choice = 0;
+    unsigned char reread = 1;
+    unsigned char suffixlen = strlen(suffix);
+    unsigned char picked = 0;
+    unsigned char key, x, namelen;
+
+    windownew(8,6,12,24,0);
+    revers(1);
+    textcolor(mc_menupopup);
+    sprintf(buffer,"directory drive %u",targetdevice);
+    cputsxy(10,7,buffer);
+    cputsxy(10,16,"f3: read again");
+
+    do
+    {
+        // Select the matching entries from the cache, reading the directory if needed
+        if(reread)
+        {
+            count = top = choice = reread = 0;
+            cache = dircache_read(targetdevice);
+            if(cache)
+            {
+                for(x=0;x<cache->count;x++)
+                {
+                    namelen = strlen(cache->entry[x].name);
+                    if(cache->entry[x].type != CBM_T_DIR && namelen > suffixlen && namelen-suffixlen <= maxlen && !strcmp(cache->entry[x].name+namelen-suffixlen,suffix))
+                    {
+                        index[count++] = x;
+                    }
+                }
+            }
+        }
+
+        for(x=0;x<DIRPICK_ROWS;x++)
+        {
+            gotoxy(10,8+x);
+            textcolor((top+x==choice && count)? mc_pd_select : mc_menupopup);
+            if(top+x<count)
+            {
+                cprintf("%-16s %s",cache->entry[index[top+x]].name,(cache->entry[index[top+x]].type == CBM_T_SEQ)? "seq" : "prg");
+            }
+            else
+            {
+                cspaces(20);
+            }
+        }
+        if(!count)
+        {
+            textcolor(mc_menupopup);
+            cputsxy(10,8,"no files.");
+        }
+
+        key = cgetc();
+        switch (key)
+        {
+        case CH_CURS_UP:
+            if(choice) { choice--; }
+            if(choice<top) { top = choice; }
+            break;
+
+        case CH_CURS_DOWN:
+            if(choice+1<count) { choice++; }
+            if(choice>=top+DIRPICK_ROWS) { top = choice-DIRPICK_ROWS+1; }
+            break;
+
+        case CH_F3:
+            dircache_invalidate(targetdevice);
+            reread = 1;
+            break;
+
+        case CH_ENTER:
+            if(count)
+            {
+                namelen = strlen(cache->entry[index[choice]].name)-suffixlen;
+                memcpy(filename,cache->entry[index[choice]].name,namelen);
+                filename[namelen] = 0;
+                picked = 1;
+            }
+            break;
+
+        default:
+            break;
+        }
+    } while(!picked && key != CH_ESC && key != CH_STOP);
+
+    windowrestore(0);
+    textcolor(mc_menupopup);
+    return picked;
+}
+
+int chooseidandfilename(char* headertext, unsigned char maxlen, char* suffix)
 {
-    // Function to fill screen with the screencode and attribute code provided as input
+    // Function to present dialogue to enter device id and filename
+    // Input: Headertext to print, maximum length of filename input string,
+    //        suffix of the files to offer in the directory picker
+
+    unsigned char newtargetdevice;
+    unsigned char valid = 0;
+    char* ptrend;
+
+    windownew(2,5,12,36,0);
+    revers(1);
+    textcolor(mc_menupopup);
+    cputsxy(4,6,headertext);
+    do
+    {
+        cputsxy(4,8,"choose drive id:");
+        sprintf(buffer,"%u",targetdevice);
+        if(textInput(4,9,buffer,2)==-1) { return -1; }
+        newtargetdevice = (unsigned char)strtol(buffer,&ptrend,10);
+        if(newtargetdevice > 7 && newtargetdevice<31)
+        {
+            valid = 1;
+            targetdevice=newtargetdevice;
+        }
+        else{
+            cputsxy(4,10,"invalid id. enter valid one.");
+        }
+    } while (valid==0);
+    cputsxy(4,10,"choose filename (f3: dir):  ");
+    do
+    {
+        valid = textInput(4,11,filename,maxlen);
+        if(valid==-2 && dirpicker(suffix,maxlen))
+        {
+            valid = strlen(filename);
+        }
+    } while (valid==-2);
+    revers(0);
+    textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));
+    return valid;
+}
 
-    unsigned int address = SCREENMAPBASE;
+unsigned char checkiffileexists(char* filetocheck, unsigned char id)
+{
+    // Check if file exists and, if yes, ask confirmation of overwrite
     
-    memset((void*)address,attribute,screentotal);
-    placesignature();
-    address += screentotal + 24;
-    memset((void*)address,screencode,screentotal);
+    struct DirCache* cache = dircache_read(id);
+    unsigned char proceed = 1;
+    unsigned char yesno;
+    unsigned char exists;
+
+    // Answer from the cached directory, ask the drive if the file could be missing from the cache
+    if(cache && (cache->complete || dircache_find(cache,filetocheck) != -1))
+    {
+        exists = (dircache_find(cache,filetocheck) != -1);
+    }
+    else
+    {
+        sprintf(buffer,"r0:%s=%s",filetocheck,filetocheck);
+        exists = (cmd(id,buffer) == 63);
+    }
+
+    if (exists)
+    {
+        yesno = areyousure("file exists.",0);
+        if(yesno==2)
+        {
+            proceed = 0;
+        }
+        else
+        {
+            proceed = 2;
+        }
+    }
+
+    return proceed;
+}
+
+// Autosave journal routines
+
+void journal_setbase(char* name)
+{
+    // Start journaling modified rows relative to a saved or loaded file
+    // Input: base filename, empty to stop journaling until the next save or load
+
+    strcpy(journalbase,name);
+    journaldevice = targetdevice;
+    journalstarted = 0;
+    memset(dirtyrows,0,DIRTYROWS_SIZE);
+    dirtyrows_any = 0;
+    journaltime = clock();
+}
+
+void journal_scratch()
+{
+    // Remove the journal from the target device, skipped if the cached directory shows there is none
+
+    struct DirCache* cache = dircache_slot(targetdevice);
+
+    if(cache->device == targetdevice && cache->complete && dircache_find(cache,JRNL_NAME) == -1) { return; }
+
+    sprintf(buffer,"s:%s",JRNL_NAME);
+    cmd(targetdevice,buffer);
+    dircache_remove(JRNL_NAME,targetdevice);
+}
+
+void journal_saved(char* name)
+{
+    // Compact the journal after an explicit save: the saved file holds all rows, so the journal is removed
+    // Input: saved filename
+
+    journal_scratch();
+    journal_setbase(name);
+}
+
+void journal_append()
+{
+    // Append the rows modified since the last autosave to the journal, once per interval
+
+    unsigned char header[JRNL_HEADERSIZE];
+    unsigned char error = 0;
+    unsigned int row;
+
+    if(!journalbase[0] || !dirtyrows_any || clock()-journaltime < JRNL_INTERVAL*CLOCKS_PER_SEC) { return; }
+
+    strcpy(programmode,"autosave");
+    if(showbar) { printstatusbar(); }
+
+    // First autosave after the base was set starts a new journal with a header
+    if(!journalstarted)
+    {
+        sprintf(buffer,"s:%s",JRNL_NAME);
+        cmd(journaldevice,buffer);
+        sprintf(buffer,"%s,s,w",JRNL_NAME);
+    }
+    else
+    {
+        sprintf(buffer,"%s,s,a",JRNL_NAME);
+    }
+
+    if(cbm_open(SCRN_LFN,journaldevice,SCRN_LFN,buffer))
+    {
+        error = _oserror;
+    }
+    else
+    {
+        if(!journalstarted)
+        {
+            header[0] = JRNL_MAGIC0;
+            header[1] = JRNL_MAGIC1;
+            header[2] = JRNL_MAGIC2;
+            header[3] = JRNL_VERSION;
+            header[4] = (screenwidth>>8) & 0xff;
+            header[5] = screenwidth & 0xff;
+            header[6] = (screenheight>>8) & 0xff;
+            header[7] = screenheight & 0xff;
+            memset(header+8,0,16);
+            memcpy(header+8,journalbase,strlen(journalbase));
+            if(cbm_write(SCRN_LFN,header,JRNL_HEADERSIZE) != JRNL_HEADERSIZE) { error = 255; }
+        }
+
+        // One record per modified row: row number, attribute data and character data
+        for(row=0;row<screenheight && !error;row++)
+        {
+            if(dirtyrows[row>>3] & (1<<(row&7)))
+            {
+                header[0] = (row>>8) & 0xff;
+                header[1] = row & 0xff;
+                if(cbm_write(SCRN_LFN,header,2) != 2 ||
+                   cbm_write(SCRN_LFN,(void*)screenmap_attraddr(row,0),screenwidth) != (int)screenwidth ||
+                   cbm_write(SCRN_LFN,(void*)screenmap_screenaddr(row,0),screenwidth) != (int)screenwidth)
+                {
+                    error = 255;
+                }
+            }
+        }
+        cbm_close(SCRN_LFN);
+    }
+
+    if(journaldevice == targetdevice) { dircache_saved(JRNL_NAME,CBM_T_SEQ,error); }
+
+    if(error)
+    {
+        // Stop autosave until the next save or load instead of failing on every interval
+        journal_setbase("");
+        fileerrormessage(error,1);
+    }
+    else
+    {
+        journalstarted = 1;
+        memset(dirtyrows,0,DIRTYROWS_SIZE);
+        dirtyrows_any = 0;
+        journaltime = clock();
+    }
+
+    strcpy(programmode,"main");
+}
+
+void journal_merge(char* name)
+{
+    // Offer to apply the rows of a journal made for a just loaded file and continue journaling on it
+    // Input: loaded filename
+
+    struct DirCache* cache;
+    unsigned char header[JRNL_HEADERSIZE];
+    unsigned char found = 0;
+    unsigned int row;
+
+    journal_setbase(name);
+
+    cache = dircache_read(targetdevice);
+    if(cache && cache->complete && dircache_find(cache,JRNL_NAME) == -1) { return; }
+
+    sprintf(buffer,"%s,s,r",JRNL_NAME);
+    if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,buffer)) { return; }
+
+    // Only a journal with the same base file and dimensions applies
+    if(cbm_read(SCRN_LFN,header,JRNL_HEADERSIZE) == JRNL_HEADERSIZE &&
+       header[0] == JRNL_MAGIC0 && header[1] == JRNL_MAGIC1 && header[2] == JRNL_MAGIC2 && header[3] == JRNL_VERSION &&
+       header[4]*256+header[5] == screenwidth && header[6]*256+header[7] == screenheight &&
+       !strncmp((char*)header+8,name,16))
+    {
+        found = 1;
+        if(areyousure("apply autosaved changes.",0) == 1)
+        {
+            // Rows journaled more than once are applied in order, so the last version wins
+            while(cbm_read(SCRN_LFN,header,2) == 2)
+            {
+                row = header[0]*256+header[1];
+                if(row >= screenheight ||
+                   cbm_read(SCRN_LFN,(void*)screenmap_attraddr(row,0),screenwidth) != (int)screenwidth ||
+                   cbm_read(SCRN_LFN,(void*)screenmap_screenaddr(row,0),screenwidth) != (int)screenwidth)
+                {
+                    break;
+                }
+            }
+            journalstarted = 1;
+        }
+    }
+    cbm_close(SCRN_LFN);
+
+    // Declined journal is discarded
+    if(found && !journalstarted) { journal_scratch(); }
 }
 
 void cursormove(unsigned char left, unsigned char right, unsigned char up, unsigned char down)
@@ -761,7 +1221,7 @@ void cursormove(unsigned char left, unsigned char right, unsigned char up, unsig
             if(xoffset>0)
             {
                 gotoxy(screen_col,screen_row);
-                TED_ScrollCopy(SCREENMAPBASE,screenwidth,screenheight,xoffset--,yoffset,0,0,40,25,2);
+                TED_ScrollCopy(SCREENMAPBASE,screenstride,screenplane,xoffset--,yoffset,0,0,40,25,2);
                 initstatusbar();
             }
         }
@@ -777,7 +1237,7 @@ void cursormove(unsigned char left, unsigned char right, unsigned char up, unsig
             if(xoffset+screen_col<screenwidth-1)
             {
                 gotoxy(screen_col,screen_row);
-                TED_ScrollCopy(SCREENMAPBASE,screenwidth,screenheight,xoffset++,yoffset,0,0,40,25,1);
+                TED_ScrollCopy(SCREENMAPBASE,screenstride,screenplane,xoffset++,yoffset,0,0,40,25,1);
                 initstatusbar();
             }
         }
@@ -793,7 +1253,7 @@ void cursormove(unsigned char left, unsigned char right, unsigned char up, unsig
             if(yoffset>0)
             {
                 gotoxy(screen_col,screen_row);
-                TED_ScrollCopy(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset--,0,0,40,25,4);
+                TED_ScrollCopy(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset--,0,0,40,25,4);
                 initstatusbar();
             }
         }
@@ -811,7 +1271,7 @@ void cursormove(unsigned char left, unsigned char right, unsigned char up, unsig
             if(yoffset+screen_row<screenheight-1)
             {
                 gotoxy(screen_col,screen_row);
-                TED_ScrollCopy(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset++,0,0,40,25,8);
+                TED_ScrollCopy(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset++,0,0,40,25,8);
                 initstatusbar();
             }
         }
@@ -839,12 +1299,28 @@ void helpscreen_load(unsigned char screennumber)
     bordercolor(COLOR_BLACK);
     cursor(0);
 
-    // Load selected help screen
-    sprintf(buffer,"tedse.hsc%u",screennumber);
-
-    if(TED_Load(buffer,bootdevice,COLORMEMORY)<=COLORMEMORY)
+    // Unpack selected help screen from cache, or load from disk on cache miss
+    if(helpcache[screennumber-1])
     {
-        messagepopup("insert application disk.",0);
+        TED_RLE_Unpack((unsigned int)helpcache[screennumber-1],COLORMEMORY);
+    }
+    else
+    {
+        sprintf(buffer,"tedse.hsc%u",screennumber);
+
+        if(TED_Load(buffer,bootdevice,COLORMEMORY)<=COLORMEMORY)
+        {
+            messagepopup("insert application disk.",0);
+        }
+        else
+        {
+            // Store packed copy in free memory, skip caching if no memory is available
+            helpcache[screennumber-1] = malloc(RLE_WORSTCASE(HELPSCREENSIZE));
+            if(helpcache[screennumber-1])
+            {
+                helpcache[screennumber-1] = realloc(helpcache[screennumber-1],TED_RLE_Pack(COLORMEMORY,(unsigned int)helpcache[screennumber-1],HELPSCREENSIZE));
+            }
+        }
     }
     
     cgetc();
@@ -852,7 +1328,7 @@ void helpscreen_load(unsigned char screennumber)
     // Restore screen
     bgcolor(screenbackground);
     bordercolor(screenborder);
-    TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+    TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
     if(showbar) { initstatusbar(); }
     if(screennumber!=2)
     {
@@ -868,29 +1344,79 @@ void helpscreen_load(unsigned char screennumber)
     }
 }
 
-// Application routines
-void plotmove(unsigned char direction)
+unsigned char loadassetbundle()
 {
-    // Drive cursor move
-    // Input: ASCII code of cursor key pressed
+    // Function to load all startup assets with one load from the packed asset bundle
+    // Help screens are stored packed in the help screen cache
+    // Output: 1 if bundle was loaded, 0 if bundle was not found
 
-    TED_Plot(screen_row,screen_col,PEEK(screenmap_screenaddr(yoffset+screen_row,xoffset+screen_col,screenwidth,screenheight)),PEEK(screenmap_attraddr(yoffset+screen_row,xoffset+screen_col,screenwidth)));
+    unsigned char entries, x, id;
+    unsigned int index = SCREENMAPBASE+1;
+    unsigned int address, packedsize;
 
-    switch (direction)
+    // Load bundle in screen map area, which is cleared after start up
+    if(TED_Load("tedse.data",bootdevice,SCREENMAPBASE)<=SCREENMAPBASE) { return 0; }
+
+    entries = PEEK(SCREENMAPBASE);
+    address = index + entries*3;
+
+    for(x=0;x<entries;x++)
     {
-    case CH_CURS_LEFT:
-        cursormove(1,0,0,0);
-        break;
-    
-    case CH_CURS_RIGHT:
-        cursormove(0,1,0,0);
-        break;
+        id = PEEK(index);
+        packedsize = PEEKW(index+1);
 
-    case CH_CURS_UP:
-        cursormove(0,0,1,0);
-        break;
+        switch (id)
+        {
+        case ASSET_TITLESCREEN:
+            TED_RLE_Unpack(address,COLORMEMORY);
+            break;
 
-    case CH_CURS_DOWN:
+        case ASSET_PETSCIIMAP:
+            TED_RLE_Unpack(address,PETSCIIMAP);
+            break;
+        
+        default:
+            if(id>=ASSET_HELPSCREEN && id<ASSET_HELPSCREEN+4)
+            {
+                helpcache[id-ASSET_HELPSCREEN] = malloc(packedsize);
+                if(helpcache[id-ASSET_HELPSCREEN])
+                {
+                    memcpy(helpcache[id-ASSET_HELPSCREEN],(void*)address,packedsize);
+                }
+            }
+            break;
+        }
+
+        index += 3;
+        address += packedsize;
+    }
+
+    return 1;
+}
+
+// Application routines
+void plotmove(unsigned char direction)
+{
+    // Drive cursor move
+    // Input: ASCII code of cursor key pressed
+
+    TED_Plot(screen_row,screen_col,PEEK(screenmap_screenaddr(yoffset+screen_row,xoffset+screen_col)),PEEK(screenmap_attraddr(yoffset+screen_row,xoffset+screen_col)));
+
+    switch (direction)
+    {
+    case CH_CURS_LEFT:
+        cursormove(1,0,0,0);
+        break;
+    
+    case CH_CURS_RIGHT:
+        cursormove(0,1,0,0);
+        break;
+
+    case CH_CURS_UP:
+        cursormove(0,0,1,0);
+        break;
+
+    case CH_CURS_DOWN:
         cursormove(0,0,0,1);
         break;
     
@@ -931,6 +1457,10 @@ void plot_try()
     cursor(1);
 }
 
+// Overlay 1: character editor
+#pragma code-name ("OVERLAY1")
+#pragma rodata-name ("OVERLAY1")
+
 void showchareditfield()
 {
     // Function to draw char editor background field
@@ -995,6 +1525,10 @@ void showchareditgrid(unsigned int screencode)
     }
 }
 
+// Overlay 11: write mode and PETSCII import
+#pragma code-name ("OVERLAY11")
+#pragma rodata-name ("OVERLAY11")
+
 void writemode()
 {
     // Write mode with screencodes
@@ -1035,6 +1569,11 @@ void writemode()
             }
             break;
 
+        // Import PETSCII SEQ file at cursor
+        case CH_F3:
+            importseq();
+            break;
+
         // Decrease luminance
         case CH_F5:
             if(plotluminance==0) { newval = 7; } else { newval = plotluminance - 1; }
@@ -1174,6 +1713,10 @@ void writemode()
     strcpy(programmode,"main");
 }
 
+// Overlay 13: palette and color write modes
+#pragma code-name ("OVERLAY13")
+#pragma rodata-name ("OVERLAY13")
+
 void colorwrite()
 {
     // Write mode with colors
@@ -1187,7 +1730,7 @@ void colorwrite()
         key = cgetc();
 
         // Get old attribute value
-        attribute = PEEK(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset,screenwidth));
+        attribute = PEEK(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset));
 
         switch (key)
         {
@@ -1203,7 +1746,8 @@ void colorwrite()
         // Toggle blink
         case CH_F1:
             attribute ^= 0x80;           // Toggle bit 7 for blink
-            POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset,screenwidth),attribute);
+            dirtyrows_mark(screen_row+yoffset,1);
+            POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset),attribute);
             plotmove(CH_CURS_RIGHT);
             break;
 
@@ -1231,7 +1775,8 @@ void colorwrite()
             {
                 attribute &= 0x8f;                  // Erase bits 4-6
                 attribute += (key-33)*16;           // Add color 0-9 with key 0-9
-                POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset,screenwidth),attribute);
+                dirtyrows_mark(screen_row+yoffset,1);
+                POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset),attribute);
                 plotmove(CH_CURS_RIGHT);
             }
             // If keypress is 0-9 or A-F select color
@@ -1239,14 +1784,16 @@ void colorwrite()
             {
                 attribute &= 0xf0;                  // Erase bits 0-3
                 attribute += (key -48);             // Add color 0-9 with key 0-9
-                POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset,screenwidth),attribute);
+                dirtyrows_mark(screen_row+yoffset,1);
+                POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset),attribute);
                 plotmove(CH_CURS_RIGHT);
             }
             if(key>64 && key<71)
             {
                 attribute &= 0xf0;                  // Erase bits 0-3
                 attribute += (key -55);             // Add color 10-15 with key A-F
-                POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset,screenwidth),attribute);
+                dirtyrows_mark(screen_row+yoffset,1);
+                POKE(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset),attribute);
                 plotmove(CH_CURS_RIGHT);
             }
             break;
@@ -1513,15 +2060,17 @@ void palette()
     strcpy(programmode,"main");
 }
 
+// Overlay 3: resize
+#pragma code-name ("OVERLAY3")
+#pragma rodata-name ("OVERLAY3")
+
 void resizewidth()
 {
     // Function to resize screen canvas width
 
     unsigned int newwidth = screenwidth;
-    unsigned int maxsize = MEMORYLIMIT - SCREENMAPBASE;
     unsigned char areyousure = 0;
     unsigned char sizechanged = 0;
-    unsigned int y;
     char* ptrend;
 
     windownew(2,5,12,36,0);
@@ -1535,7 +2084,7 @@ void resizewidth()
     textInput(4,9,buffer,4);
     newwidth = (unsigned int)strtol(buffer,&ptrend,10);
 
-    if((newwidth*screenheight*2) + 24 > maxsize || newwidth<40 )
+    if(!screenmap_fits(newwidth,screenheight))
     {
         cputsxy(4,11,"new size unsupported. press key.");
         cgetc();
@@ -1549,34 +2098,16 @@ void resizewidth()
             areyousure = menupulldown(20,13,5,0);
             if(areyousure==1)
             {
-                for(y=1;y<screenheight;y++)
-                {
-                    memcpy((void*)SCREENMEMORY,(void*)screenmap_attraddr(y,0,screenwidth),newwidth);
-                    memcpy((void*)screenmap_attraddr(y,0,newwidth),(void*)SCREENMEMORY,newwidth);
-                }
-                for(y=0;y<screenheight;y++)
-                {
-                    memcpy((void*)SCREENMEMORY,(void*)screenmap_screenaddr(y,0,screenwidth,screenheight),newwidth);
-                    memcpy((void*)screenmap_screenaddr(y,0,newwidth,screenheight),(void*)SCREENMEMORY,newwidth);
-                }
+                TED_BlankStart();
+                screenmap_resizewidth(newwidth);
                 if(screen_col>newwidth-1) { screen_col=newwidth-1; }
                 sizechanged = 1;
             }
         }
         if(newwidth > screenwidth)
         {
-            for(y=0;y<screenheight;y++)
-            {
-                memcpy((void*)SCREENMEMORY,(void*)screenmap_screenaddr(screenheight-y-1,0,screenwidth,screenheight),screenwidth);
-                memcpy((void*)screenmap_screenaddr(screenheight-y-1,0,newwidth,screenheight),(void*)SCREENMEMORY,screenwidth);
-                memset((void*)screenmap_screenaddr(screenheight-y-1,screenwidth,newwidth,screenheight),CH_SPACE,newwidth-screenwidth);
-            }
-            for(y=0;y<screenheight;y++)
-            {
-                memcpy((void*)SCREENMEMORY,(void*)screenmap_attraddr(screenheight-y-1,0,screenwidth),screenwidth);
-                memcpy((void*)screenmap_attraddr(screenheight-y-1,0,newwidth),(void*)SCREENMEMORY,screenwidth);
-                memset((void*)screenmap_attraddr(screenheight-y-1,screenwidth,newwidth),COLOR_WHITE,newwidth-screenwidth);
-            }
+            TED_BlankStart();
+            screenmap_resizewidth(newwidth);
             sizechanged = 1;
         }
     }
@@ -1585,17 +2116,22 @@ void resizewidth()
 
     if(sizechanged==1)
     {
-        screenwidth = newwidth;
-        screentotal = screenwidth * screenheight;
         xoffset = 0;
-        placesignature();
-        TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+        TED_BlankEnd(screenborder);
+
+        // Journal rows no longer match the saved file
+        journal_setbase("");
+        TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
         sprintf(pulldownmenutitles[0][0],"width:    %5i ",screenwidth);
         menuplacebar();
         if(showbar) { initstatusbar(); }
     }
 }
 
+// Overlay 12: line and box, move and select modes
+#pragma code-name ("OVERLAY12")
+#pragma rodata-name ("OVERLAY12")
+
 void plotvisible(unsigned char row, unsigned char col, unsigned char setorrestore)
 {
     // Plot or erase part of line or box if in visible viewport
@@ -1610,7 +2146,7 @@ void plotvisible(unsigned char row, unsigned char col, unsigned char setorrestor
         }
         else
         {
-            TED_Plot(row-yoffset, col-xoffset,PEEK(screenmap_screenaddr(row,col,screenwidth,screenheight)),PEEK(screenmap_attraddr(row,col,screenwidth)));
+            TED_Plot(row-yoffset, col-xoffset,PEEK(screenmap_screenaddr(row,col)),PEEK(screenmap_attraddr(row,col)));
         }
     }
 }
@@ -1705,16 +2241,12 @@ void lineandbox(unsigned char draworselect)
 
     if(key==CH_ENTER && draworselect ==1)
     {
-        for(y=select_starty;y<select_endy+1;y++)
-        {
-            memset((void*)screenmap_screenaddr(y,select_startx,screenwidth,screenheight),plotscreencode,select_width);
-            memset((void*)screenmap_attraddr(y,select_startx,screenwidth),TED_Attribute(plotcolor,plotluminance,plotblink),select_width);
-        }
+        screenmap_fillarea(select_starty,select_startx,select_width,select_height,plotscreencode,TED_Attribute(plotcolor,plotluminance,plotblink),FILL_SCREENCODE | FILL_ATTRIBUTE);
         TED_Plot(screen_row,screen_col,plotscreencode,TED_Attribute(plotcolor,plotluminance,plotblink));
     }
     else
     {
-        TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+        TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
         if(showbar) { initstatusbar(); }
         if(key==CH_ENTER) { select_accept=1; }
     }
@@ -1734,7 +2266,7 @@ void movemode()
     strcpy(programmode,"move");
 
     cursor(0);
-    TED_Plot(screen_row,screen_col,PEEK(screenmap_screenaddr(yoffset+screen_row,xoffset+screen_col,screenwidth,screenheight)),PEEK(screenmap_attraddr(yoffset+screen_row,xoffset+screen_col,screenwidth)));
+    TED_Plot(screen_row,screen_col,PEEK(screenmap_screenaddr(yoffset+screen_row,xoffset+screen_col)),PEEK(screenmap_attraddr(yoffset+screen_row,xoffset+screen_col)));
     
     if(showbar) { hidestatusbar(); }
 
@@ -1783,11 +2315,12 @@ void movemode()
         {
             for(y=0;y<25;y++)
             {
-                memcpy((void*)screenmap_screenaddr(y+yoffset,xoffset,screenwidth,screenheight),(void*)(SCREENMEMORY+(y*40)),40);
-                memcpy((void*)screenmap_attraddr(y+yoffset,xoffset,screenwidth),(void*)(COLORMEMORY+(y*40)),40);
+                memcpy((void*)screenmap_screenaddr(y+yoffset,xoffset),(void*)(SCREENMEMORY+(y*40)),40);
+                memcpy((void*)screenmap_attraddr(y+yoffset,xoffset),(void*)(COLORMEMORY+(y*40)),40);
             }
+            dirtyrows_mark(yoffset,25);
         }
-        TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+        TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
         if(showbar) { initstatusbar(); }
     }
 
@@ -1797,19 +2330,20 @@ void movemode()
     if(showbar) { printstatusbar(); }
 }
 
-void selectmode()
+unsigned char selectmode()
 {
     // Function to select a screen area to delete, cut, copy or paint
+    // Output: chosen key, 'w' if the caller should save the selection as region
 
-    unsigned char key,movekey,x,y,ycount;
+    unsigned char key,movekey;
 
     strcpy(programmode,"select");
 
     movekey = 0;
     lineandbox(0);
-    if(select_accept == 0) { return; }
+    if(select_accept == 0) { return 0; }
 
-    strcpy(programmode,"x/c/d/a/p?");
+    strcpy(programmode,"xcdapw?");
 
     do
     {
@@ -1824,14 +2358,14 @@ void selectmode()
 
         if(key==CH_F8) { helpscreen_load(3); }
 
-    } while (key !='d' && key !='x' && key !='c' && key != 'p' && key !='a' && key != CH_ESC && key != CH_STOP );
+    } while (key !='d' && key !='x' && key !='c' && key != 'p' && key !='a' && key !='w' && key != CH_ESC && key != CH_STOP );
 
     if(key!=CH_ESC && key != CH_STOP)
     {
         if((key=='x' || key=='c')&&(select_width>4096))
         {
             messagepopup("selection too big.",1);
-            return;
+            return 0;
         }
 
         if(key=='x' || key=='c')
@@ -1873,66 +2407,105 @@ void selectmode()
                 if((screen_col+xoffset+select_width>screenwidth) || (screen_row+yoffset+select_height>screenheight))
                 {
                     messagepopup("selection does not fit.",1);
-                    return;
+                    return 0;
                 }
 
-                for(ycount=0;ycount<select_height;ycount++)
-                {
-                    y=(screen_row+yoffset>=select_starty)? select_height-ycount-1 : ycount;
-                    memcpy((void*)SCREENMEMORY,(void*)screenmap_attraddr(select_starty+y,select_startx,screenwidth),select_width);
-                    if(key=='x') { memset((void*)screenmap_attraddr(select_starty+y,select_startx,screenwidth),COLOR_WHITE,select_width); }
-                    memcpy((void*)screenmap_attraddr(screen_row+yoffset+y,screen_col+xoffset,screenwidth),(void*)SCREENMEMORY,select_width);
-                    memcpy((void*)SCREENMEMORY,(void*)screenmap_screenaddr(select_starty+y,select_startx,screenwidth,screenheight),select_width);
-                    if(key=='x') {memset((void*)screenmap_screenaddr(select_starty+y,select_startx,screenwidth,screenheight),CH_SPACE,select_width); }
-                    memcpy((void*)screenmap_screenaddr(screen_row+yoffset+y,screen_col+xoffset,screenwidth,screenheight),(void*)SCREENMEMORY,select_width);
-                }
+                screenmap_copyarea(select_starty,select_startx,screen_row+yoffset,screen_col+xoffset,select_width,select_height,key=='x');
             }
         }
 
         if( key=='d')
         {
-            for(y=0;y<select_height;y++)
-            {
-                memset((void*)screenmap_screenaddr(select_starty+y,select_startx,screenwidth,screenheight),CH_SPACE,select_width);
-                memset((void*)screenmap_attraddr(select_starty+y,select_startx,screenwidth),COLOR_WHITE,select_width);
-            }
+            screenmap_fillarea(select_starty,select_startx,select_width,select_height,CH_SPACE,COLOR_WHITE,FILL_SCREENCODE | FILL_ATTRIBUTE);
         }
 
         if(key=='a')
         {
-            for(y=0;y<select_height;y++)
-            {
-                memset((void*)screenmap_attraddr(select_starty+y,select_startx,screenwidth),TED_Attribute(plotcolor,plotluminance,plotblink),select_width);
-            }
+            screenmap_fillarea(select_starty,select_startx,select_width,select_height,CH_SPACE,TED_Attribute(plotcolor,plotluminance,plotblink),FILL_ATTRIBUTE);
         }
 
         if(key=='p')
         {
-            for(y=0;y<select_height;y++)
-            {
-                for(x=0;x<select_width;x++)
-                {
-                    POKE(screenmap_attraddr(select_starty+y,select_startx+x,screenwidth),(PEEK(screenmap_attraddr(select_starty+y,select_startx+x,screenwidth)) & 0xf0)+plotcolor);
-                }
-            }
+            screenmap_paintarea(select_starty,select_startx,select_width,select_height,plotcolor);
         }
 
-        TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+        TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
         if(showbar) { initstatusbar(); }
         TED_Plot(screen_row,screen_col,plotscreencode,TED_Attribute(plotcolor,plotluminance,plotblink));
     }
     strcpy(programmode,"main");
+    return key;
+}
+
+// Overlay 8: fill
+#pragma code-name ("OVERLAY8")
+#pragma rodata-name ("OVERLAY8")
+
+void fillregion(unsigned char mode)
+{
+    // Flood fill of the connected area under the cursor with the present screencode and/or attribute
+    // Input: mode: match and replace screencode (FILL_SCREENCODE), attribute (FILL_ATTRIBUTE) or both
+
+    unsigned int x = screen_col + xoffset;
+    unsigned int y = screen_row + yoffset;
+    unsigned char newattr = TED_Attribute(plotcolor,plotluminance,plotblink);
+    unsigned char overflow;
+
+    // Nothing to do if the fill would not change the area
+    if(!screenmap_fillchanges(x,y,mode,plotscreencode,newattr)) { return; }
+
+    TED_BlankStart();
+    overflow = screenmap_floodfill(x,y,mode,plotscreencode,newattr);
+    TED_BlankEnd(screenborder);
+    TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
+    if(showbar) { initstatusbar(); }
+    if(overflow) { messagepopup("area too complex, fill rest.",1); }
+    TED_Plot(screen_row,screen_col,plotscreencode,newattr);
+}
+
+void fillmode()
+{
+    // Function to select what to match for a flood fill from the cursor position
+
+    unsigned char key;
+
+    strcpy(programmode,"fill c/a/b");
+    if(showbar) { printstatusbar(); }
+
+    key = cgetc();
+
+    switch (key)
+    {
+    case 'c':
+        fillregion(FILL_SCREENCODE);
+        break;
+
+    case 'a':
+        fillregion(FILL_ATTRIBUTE);
+        break;
+
+    case 'b':
+        fillregion(FILL_SCREENCODE | FILL_ATTRIBUTE);
+        break;
+
+    default:
+        break;
+    }
+
+    strcpy(programmode,"main");
 }
 
+// Overlay 3: resize
+#pragma code-name ("OVERLAY3")
+#pragma rodata-name ("OVERLAY3")
+
 void resizeheight()
 {
     // Function to resize screen camvas height
 
     unsigned int newheight = screenheight;
-    unsigned int maxsize = MEMORYLIMIT - SCREENMAPBASE;
     unsigned char areyousure = 0;
     unsigned char sizechanged = 0;
-    unsigned char y;
     char* ptrend;
 
     windownew(2,5,12,36,0);
@@ -1946,7 +2519,7 @@ void resizeheight()
     textInput(4,9,buffer,4);
     newheight = (unsigned int)strtol(buffer,&ptrend,10);
 
-    if((newheight*screenwidth*2) + 48 > maxsize || newheight < 25)
+    if(!screenmap_fits(screenwidth,newheight))
     {
         cputsxy(4,11,"new size unsupported. press key.");
         cgetc();
@@ -1960,19 +2533,16 @@ void resizeheight()
             areyousure = menupulldown(20,13,5,0);
             if(areyousure==1)
             {
-                memcpy((void*)screenmap_screenaddr(0,0,screenwidth,newheight),(void*)screenmap_screenaddr(0,0,screenwidth,screenheight),screenheight*screenwidth);
+                TED_BlankStart();
+                screenmap_resizeheight(newheight);
                 if(screen_row>newheight-1) { screen_row=newheight-1; }
                 sizechanged = 1;
             }
         }
         if(newheight > screenheight)
         {
-            for(y=0;y<screenheight;y++)
-            {
-                memcpy((void*)screenmap_screenaddr(screenheight-y-1,0,screenwidth,newheight),(void*)screenmap_screenaddr(screenheight-y-1,0,screenwidth,screenheight),screenwidth);
-            }
-            memset((void*)screenmap_screenaddr(screenheight,0,screenwidth,newheight),CH_SPACE,(newheight-screenheight)*screenwidth);
-            memset((void*)screenmap_attraddr(screenheight,0,screenwidth),COLOR_WHITE,(newheight-screenheight)*screenwidth);
+            TED_BlankStart();
+            screenmap_resizeheight(newheight);
             sizechanged = 1;
         }
     }
@@ -1981,107 +2551,143 @@ void resizeheight()
 
     if(sizechanged==1)
     {
-        screenheight = newheight;
-        screentotal = screenwidth * screenheight;
         yoffset=0;
-        placesignature();
-        TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+        TED_BlankEnd(screenborder);
+
+        // Journal rows no longer match the saved file
+        journal_setbase("");
+        TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
         sprintf(pulldownmenutitles[0][1],"height:   %5i ",screenheight);
         menuplacebar();
         if(showbar) { initstatusbar(); }
     }
 }
 
-int chooseidandfilename(char* headertext, unsigned char maxlen)
-{
-    // Function to present dialogue to enter device id and filename
-    // Input: Headertext to print, maximum length of filename input string
+// Overlay 2: screen and charset load and save
+#pragma code-name ("OVERLAY2")
+#pragma rodata-name ("OVERLAY2")
 
-    unsigned char newtargetdevice;
-    unsigned char valid = 0;
-    char* ptrend;
+unsigned char screenmap_savefile(char* name)
+{
+    // Function to save screenmap in packed layout as RLE compressed screen file
+    // with a header holding dimensions, colors and checksum
+    // Input: filename
+    // Output: error code, 0 if no error
+
+    unsigned char header[SCRN_HEADERSIZE];
+    unsigned int length = (screentotal*2)+24;
+    unsigned int checksum = TED_Checksum(SCREENMAPBASE,length);
+    char openname[25];
+    unsigned char error;
 
-    windownew(2,5,12,36,0);
-    revers(1);
-    textcolor(mc_menupopup);
-    cputsxy(4,6,headertext);
-    do
+    header[ 0] = SCRN_MAGIC0;
+    header[ 1] = SCRN_MAGIC1;
+    header[ 2] = SCRN_MAGIC2;
+    header[ 3] = SCRN_VERSION;
+    header[ 4] = (screenwidth>>8) & 0xff;
+    header[ 5] = screenwidth & 0xff;
+    header[ 6] = (screenheight>>8) & 0xff;
+    header[ 7] = screenheight & 0xff;
+    header[ 8] = screenbackground;
+    header[ 9] = screenborder;
+    header[10] = (checksum>>8) & 0xff;
+    header[11] = checksum & 0xff;
+
+    sprintf(openname,"%s,p,w",name);
+    if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,openname)) { return _oserror; }
+
+    if(cbm_write(SCRN_LFN,header,SCRN_HEADERSIZE) != SCRN_HEADERSIZE)
     {
-        cputsxy(4,8,"choose drive id:");
-        sprintf(buffer,"%u",targetdevice);
-        if(textInput(4,9,buffer,2)==-1) { return -1; }
-        newtargetdevice = (unsigned char)strtol(buffer,&ptrend,10);
-        if(newtargetdevice > 7 && newtargetdevice<31)
-        {
-            valid = 1;
-            targetdevice=newtargetdevice;
-        }
-        else{
-            cputsxy(4,10,"invalid id. enter valid one.");
-        }
-    } while (valid==0);
-    cputsxy(4,10,"choose filename:            ");
-    valid = textInput(4,11,filename,maxlen);
-    revers(0);
-    textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));
-    return valid;
+        error = 255;
+    }
+    else
+    {
+        error = TED_RLE_Write(SCRN_LFN,SCREENMAPBASE,length)? 255 : 0;
+    }
+
+    cbm_close(SCRN_LFN);
+    return error;
 }
 
-unsigned char checkiffileexists(char* filetocheck, unsigned char id)
+unsigned char screenmap_openfile(char* name, unsigned char* header)
 {
-    // Check if file exists and, if yes, ask confirmation of overwrite
-    
-    unsigned char proceed = 1;
-    unsigned char yesno;
-    unsigned char error;
+    // Function to open a screen file and read the header of a compressed screen file
+    // Input: filename, buffer of SCRN_HEADERSIZE bytes for the header
+    // Output: SCRNFILE_COMPRESSED with the file left open after a valid header,
+    //         SCRNFILE_RAW for screen files without header or SCRNFILE_INVALID, file closed
 
-    sprintf(buffer,"r0:%s=%s",filetocheck,filetocheck);
-    error = cmd(id,buffer);
+    if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,name)) { return SCRNFILE_INVALID; }
 
-    if (error == 63)
+    if(cbm_read(SCRN_LFN,header,SCRN_HEADERSIZE) != SCRN_HEADERSIZE ||
+       header[0] != SCRN_MAGIC0 || header[1] != SCRN_MAGIC1 || header[2] != SCRN_MAGIC2)
     {
-        yesno = areyousure("file exists.",0);
-        if(yesno==2)
-        {
-            proceed = 0;
-        }
-        else
-        {
-            proceed = 2;
-        }
+        // No compressed screen file, so should be a raw screen file
+        cbm_close(SCRN_LFN);
+        return SCRNFILE_RAW;
     }
 
-    return proceed;
+    if(header[3] != SCRN_VERSION)
+    {
+        cbm_close(SCRN_LFN);
+        return SCRNFILE_INVALID;
+    }
+
+    return SCRNFILE_COMPRESSED;
 }
 
 void loadscreenmap()
 {
     // Function to load screenmap
 
-    unsigned int lastreadaddress, newwidth, newheight;
-    unsigned int maxsize = MEMORYLIMIT - SCREENMAPBASE;
+    unsigned char header[SCRN_HEADERSIZE];
+    unsigned int newwidth, newheight, end;
+    unsigned char format;
+    unsigned char loaded = 0;
+    unsigned char checksumerror = 0;
     char* ptrend;
     int escapeflag;
   
-    escapeflag = chooseidandfilename("load screen",15);
+    escapeflag = chooseidandfilename("load screen",15,"");
 
     if(escapeflag==-1) { windowrestore(0); return; }
 
     revers(1);
     textcolor(mc_menupopup);
 
-    cputsxy(4,12,"enter screen width:");
-    sprintf(buffer,"%i",screenwidth);
-    textInput(4,13,buffer,4);
-    newwidth = (unsigned int)strtol(buffer,&ptrend,10);
+    format = screenmap_openfile(filename,header);
 
-    cputsxy(4,14,"enter screen height:");
-    sprintf(buffer,"%i",screenheight);
-    textInput(4,15,buffer,4);
-    newheight = (unsigned int)strtol(buffer,&ptrend,10);
+    if(format == SCRNFILE_COMPRESSED)
+    {
+        // Dimensions from header
+        newwidth = header[4]*256+header[5];
+        newheight = header[6]*256+header[7];
+    }
+    else if(format == SCRNFILE_RAW)
+    {
+        // Raw screen files have no header, so ask dimensions
+        cputsxy(4,12,"enter screen width:");
+        sprintf(buffer,"%i",screenwidth);
+        textInput(4,13,buffer,4);
+        newwidth = (unsigned int)strtol(buffer,&ptrend,10);
+
+        cputsxy(4,14,"enter screen height:");
+        sprintf(buffer,"%i",screenheight);
+        textInput(4,15,buffer,4);
+        newheight = (unsigned int)strtol(buffer,&ptrend,10);
+    }
+    else
+    {
+        cputsxy(4,16,"unsupported file. Press key.");
+        cgetc();
+        windowrestore(0);
+        revers(0);
+        textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));
+        return;
+    }
 
-    if((newwidth*newheight*2) + 24 > maxsize || newwidth<40 || newheight<25)
+    if(!screenmap_fits(newwidth,newheight))
     {
+        if(format == SCRNFILE_COMPRESSED) { cbm_close(SCRN_LFN); }
         cputsxy(4,16,"new size unsupported. Press key.");
         cgetc();
         windowrestore(0);
@@ -2089,19 +2695,63 @@ void loadscreenmap()
     else
     {
         windowrestore(0);
+        TED_BlankStart();
 
-        lastreadaddress = TED_Load(filename,targetdevice,SCREENMAPBASE);
+        // Files are always in packed layout
+        screenmap_setlayout(0);
 
-        if(lastreadaddress>SCREENMAPBASE)
+        if(format == SCRNFILE_COMPRESSED)
+        {
+            // Header is checked already, so read the file once and verify the unpacked data against the checksum
+            end = SCREENMAPBASE + (newwidth*newheight*2) + 24;
+            loaded = (TED_RLE_Read(SCRN_LFN,SCREENMAPBASE,end) == end);
+            cbm_close(SCRN_LFN);
+            checksumerror = (loaded && TED_Checksum(SCREENMAPBASE,end-SCREENMAPBASE) != header[10]*256+header[11]);
+            if(checksumerror) { loaded = 0; }
+        }
+        else
+        {
+            loaded = (TED_Load(filename,targetdevice,SCREENMAPBASE) > SCREENMAPBASE);
+        }
+
+        if(loaded)
         {
-            windowrestore(0);
             screenwidth = newwidth;
             screenheight = newheight;
-            TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
-            windowsave(0,1,0);
-            menuplacebar();
-            if(showbar) { initstatusbar(); }
+            screentotal = screenwidth * screenheight;
+            screenstride = screenwidth;
+            screenplane = screentotal + 24;
+            if(format == SCRNFILE_COMPRESSED)
+            {
+                screenbackground = header[8];
+                screenborder = header[9];
+                bgcolor(screenbackground);
+                bordercolor(screenborder);
+                sprintf(pulldownmenutitles[0][2],"background: %3i ",screenbackground);
+                sprintf(pulldownmenutitles[0][3],"border:     %3i ",screenborder);
+            }
         }
+
+        screenmap_setlayout(screenalign);
+
+        // A damaged or short compressed file has partly overwritten the canvas, so clear it
+        if(!loaded && format == SCRNFILE_COMPRESSED) { screenmapfill(CH_SPACE,COLOR_WHITE); }
+
+        TED_BlankEnd(screenborder);
+
+        if(loaded) { journal_merge(filename); } else { journal_setbase(""); }
+        windowrestore(0);
+        sprintf(pulldownmenutitles[0][0],"width:    %5i ",screenwidth);
+        sprintf(pulldownmenutitles[0][1],"height:   %5i ",screenheight);
+
+        // A failed read of a raw file can leave the canvas partly overwritten, so show it as it is
+        TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
+        windowsave(0,1,0);
+        menuplacebar();
+        if(showbar) { initstatusbar(); }
+
+        if(checksumerror) { messagepopup("checksum error in screen.",0); }
+        else if(!loaded) { fileerrormessage(255,0); }
     }
 
     revers(0);
@@ -2115,7 +2765,7 @@ void savescreenmap()
     unsigned char error, overwrite;
     int escapeflag;
   
-    escapeflag = chooseidandfilename("save screen",15);
+    escapeflag = chooseidandfilename("save screen",15,"");
 
     windowrestore(0);
 
@@ -2132,29 +2782,103 @@ void savescreenmap()
             cmd(targetdevice,buffer);
         }
 
-        // Set device ID
-	    cbm_k_setlfs(0, targetdevice, 0);
-    
-	    // Set filename
-	    cbm_k_setnam(filename);
-    
-	    // Load from file to memory
-	    error = cbm_k_save(SCREENMAPBASE,SCREENMAPBASE+(screenwidth*screenheight*2)+48);
+        // Save from memory to file in packed layout
+        TED_BlankStart();
+        screenmap_setlayout(0);
+        error = screenmap_savefile(filename);
+        screenmap_setlayout(screenalign);
+        TED_BlankEnd(screenborder);
+        dircache_saved(filename,CBM_T_PRG,error);
     
-        if(error) { fileerrormessage(error,0); }
+        if(error) { fileerrormessage(error,0); } else { journal_saved(filename); }
     }
 }
 
+// Overlay 5: project load and save
+#pragma code-name ("OVERLAY5")
+#pragma rodata-name ("OVERLAY5")
+
+void projectmeta_store(unsigned char* projbuffer)
+{
+    // Function to store project metadata to a buffer of PROJ_METASIZE bytes
+
+    projbuffer[ 0] = charsetchanged;
+    projbuffer[ 1] = charsetlowercase;
+    projbuffer[ 2] = screen_col;
+    projbuffer[ 3] = screen_row;
+    projbuffer[ 4] = (screenwidth>>8) & 0xff;
+    projbuffer[ 5] = screenwidth & 0xff;
+    projbuffer[ 6] = (screenheight>>8) & 0xff;
+    projbuffer[ 7] = screenheight & 0xff;
+    projbuffer[ 8] = (screentotal>>8) & 0xff;
+    projbuffer[ 9] = screentotal & 0xff;
+    projbuffer[10] = screenbackground;
+    projbuffer[11] = mc_mb_normal;
+    projbuffer[12] = mc_mb_select;
+    projbuffer[13] = mc_pd_normal;
+    projbuffer[14] = mc_pd_select;
+    projbuffer[15] = mc_menupopup;
+    projbuffer[16] = plotscreencode;
+    projbuffer[17] = plotcolor;
+    projbuffer[18] = plotluminance;
+    projbuffer[19] = plotblink;
+    projbuffer[20] = screenborder;
+}
+
+unsigned char projectmeta_fits(unsigned char* projbuffer)
+{
+    // Function to check if the screen dimensions in project metadata fit in memory
+    // Input: buffer of PROJ_METASIZE bytes
+    // Output: 1 if the dimensions fit, 0 if not
+
+    unsigned int width = projbuffer[ 4]*256+projbuffer[ 5];
+    unsigned int height = projbuffer[ 6]*256+projbuffer[ 7];
+
+    return (width>=40 && height>=25 && (unsigned long)width*height*2 + 24 <= MEMORYLIMIT - SCREENMAPBASE);
+}
+
+void projectmeta_apply(unsigned char* projbuffer)
+{
+    // Function to apply project metadata from a buffer of PROJ_METASIZE bytes,
+    // after the dimensions are checked with projectmeta_fits()
+    // Screenmap should be in packed layout
+
+    charsetchanged          = projbuffer[ 0];
+    charsetlowercase        = projbuffer[ 1];
+    screen_col              = projbuffer[ 2];
+    screen_row              = projbuffer[ 3];
+    screenwidth             = projbuffer[ 4]*256+projbuffer[ 5];
+    sprintf(pulldownmenutitles[0][0],"width:    %5i ",screenwidth);
+    screenheight            = projbuffer[ 6]*256+projbuffer[ 7];
+    sprintf(pulldownmenutitles[0][1],"height:   %5i ",screenheight);
+    screentotal             = screenwidth * screenheight;
+    screenbackground        = projbuffer[10];
+    bgcolor(screenbackground);
+    sprintf(pulldownmenutitles[0][2],"background: %3i ",screenbackground);
+    mc_mb_normal            = projbuffer[11];
+    mc_mb_select            = projbuffer[12];
+    mc_pd_normal            = projbuffer[13];
+    mc_pd_select            = projbuffer[14];
+    mc_menupopup            = projbuffer[15];
+    plotscreencode          = projbuffer[16];
+    plotcolor               = projbuffer[17];
+    plotluminance           = projbuffer[18];
+    plotblink               = projbuffer[19];
+    screenborder            = projbuffer[20];
+    sprintf(pulldownmenutitles[0][3],"border:     %3i ",screenborder);
+}
 void saveproject()
 {
-    // Function to save project (screen, charsets and metadata)
+    // Function to save project (metadata, charset and screen) as one container file
+    // The file is written under a temporary name and only replaces an old project when complete
 
     unsigned char error,overwrite;
-    char projbuffer[21];
+    unsigned char projbuffer[PROJ_HEADERSIZE];
+    unsigned int checksum;
     char tempfilename[21];
     int escapeflag;
   
-    escapeflag = chooseidandfilename("save project",10);
+    escapeflag = chooseidandfilename("save project",10,".proj");
 
     windowrestore(0);
 
@@ -2162,134 +2886,332 @@ void saveproject()
 
     sprintf(tempfilename,"%s.proj",filename);
 
-    overwrite = checkiffileexists(filename,targetdevice);
+    overwrite = checkiffileexists(tempfilename,targetdevice);
 
     if(overwrite)
     {
-        // Scratch old files
+        // Store header and project data to buffer variable
+        projbuffer[0] = PROJ_MAGIC0;
+        projbuffer[1] = PROJ_MAGIC1;
+        projbuffer[2] = PROJ_MAGIC2;
+        projbuffer[3] = PROJ_VERSION;
+        projectmeta_store(projbuffer+4);
+
+        // Scratch a temporary file left by an earlier failed save
+        cmd(targetdevice,"s:" PROJ_TEMPNAME);
+
+        // Write header, charset if changed and packed screen in one stream
+        if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,PROJ_TEMPNAME ",p,w"))
+        {
+            fileerrormessage(_oserror,0);
+            return;
+        }
+        TED_BlankStart();
+        screenmap_setlayout(0);
+        checksum = TED_Checksum(SCREENMAPBASE,(screentotal*2)+24);
+        if(charsetchanged==1) { checksum += TED_Checksum(CHARSET,128*8); }
+        projbuffer[PROJ_CHECKSUM  ] = (checksum>>8) & 0xff;
+        projbuffer[PROJ_CHECKSUM+1] = checksum & 0xff;
+        error = 0;
+        if(cbm_write(SCRN_LFN,projbuffer,PROJ_HEADERSIZE) != PROJ_HEADERSIZE) { error = 255; }
+        if(!error && charsetchanged==1 && cbm_write(SCRN_LFN,(void*)CHARSET,128*8) != 128*8) { error = 255; }
+        if(!error) { error = TED_RLE_Write(SCRN_LFN,SCREENMAPBASE,(screentotal*2)+24)? 255 : 0; }
+        screenmap_setlayout(screenalign);
+        cbm_close(SCRN_LFN);
+        TED_BlankEnd(screenborder);
+
+        if(error)
+        {
+            // Remove incomplete temporary file, an old project stays untouched
+            cmd(targetdevice,"s:" PROJ_TEMPNAME);
+            fileerrormessage(error,0);
+            return;
+        }
+
+        // Replace old project by the complete new file
         if(overwrite==2)
         {
-            sprintf(buffer,"s:%s.proj",filename);
-            cmd(targetdevice,buffer);
-            sprintf(buffer,"s:%s.scrn",filename);
-            cmd(targetdevice,buffer);
-            sprintf(buffer,"s:%s.chrs",filename);
-            cmd(targetdevice,buffer);
-            sprintf(buffer,"s:%s.chra",filename);
+            sprintf(buffer,"s:%s",tempfilename);
             cmd(targetdevice,buffer);
         }
+        sprintf(buffer,"r0:%s=" PROJ_TEMPNAME,tempfilename);
+        error = cmd(targetdevice,buffer);
+        dircache_saved(tempfilename,CBM_T_PRG,error);
 
-        // Store project data to buffer variable
-        projbuffer[ 0] = charsetchanged;
-        projbuffer[ 1] = charsetlowercase;
-        projbuffer[ 2] = screen_col;
-        projbuffer[ 3] = screen_row;
-        projbuffer[ 4] = (screenwidth>>8) & 0xff;
-        projbuffer[ 5] = screenwidth & 0xff;
-        projbuffer[ 6] = (screenheight>>8) & 0xff;
-        projbuffer[ 7] = screenheight & 0xff;
-        projbuffer[ 8] = (screentotal>>8) & 0xff;
-        projbuffer[ 9] = screentotal & 0xff;
-        projbuffer[10] = screenbackground;
-        projbuffer[11] = mc_mb_normal;
-        projbuffer[12] = mc_mb_select;
-        projbuffer[13] = mc_pd_normal;
-        projbuffer[14] = mc_pd_select;
-        projbuffer[15] = mc_menupopup;
-        projbuffer[16] = plotscreencode;
-        projbuffer[17] = plotcolor;
-        projbuffer[18] = plotluminance;
-        projbuffer[19] = plotblink;
-        projbuffer[20] = screenborder;
-	    cbm_k_setlfs(0, targetdevice, 0);
-        sprintf(buffer,"%s.proj",filename);
-	    cbm_k_setnam(buffer);
-	    error = cbm_k_save((unsigned int)projbuffer,(unsigned int)projbuffer+21);
-        if(error) { fileerrormessage(error,0); }
-
-        // Store screen data
-        cbm_k_setlfs(0, targetdevice, 0);
-        sprintf(buffer,"%s.scrn",filename);
-	    cbm_k_setnam(buffer);
-	    error = cbm_k_save(SCREENMAPBASE,SCREENMAPBASE+(screenwidth*screenheight*2)+24);
-        if(error) { fileerrormessage(error,0); }
-
-        // Store charset
-        if(charsetchanged==1)
-        {
-            cbm_k_setlfs(0, targetdevice, 0);
-            sprintf(buffer,"%s.chrs",filename);
-	        cbm_k_setnam(buffer);
-	        error = cbm_k_save(CHARSET,CHARSET+128*8);
-            if(error) { fileerrormessage(error,0); }
-        }   
+        if(error) { fileerrormessage(error,0); } else { journal_saved(tempfilename); }
     }
 }
 
-void loadproject()
+unsigned char loadproject_triple(unsigned char* projbuffer)
 {
-    // Function to load project (screen, charsets and metadata)
+    // Function to import a project saved by older versions as separate .proj, .scrn and .chrs files
+    // Input: buffer of PROJ_METASIZE bytes for the project metadata
+    // Output: 0 if loaded, error code if not
 
     unsigned int lastreadaddress;
-    unsigned char projbuffer[21];
-    int escapeflag;
-  
-    escapeflag = chooseidandfilename("load project",10);
-
-    windowrestore(0);
-
-    if(escapeflag==-1) { return; }
 
-    // Load project variables
+    // Load project variables and check them before memory is overwritten
     sprintf(buffer,"%s.proj",filename);
 	cbm_k_setlfs(0,targetdevice, 0);
 	cbm_k_setnam(buffer);
 	lastreadaddress = cbm_k_load(0,(unsigned int)projbuffer);
-    if(lastreadaddress<=(unsigned int)projbuffer) { return; }
-    charsetchanged          = projbuffer[ 0];
-    charsetlowercase        = projbuffer[ 1];
-    screen_col              = projbuffer[ 2];
-    screen_row              = projbuffer[ 3];
-    screenwidth             = projbuffer[ 4]*256+projbuffer[ 5];
-    sprintf(pulldownmenutitles[0][0],"width:    %5i ",screenwidth);
-    screenheight            = projbuffer[ 6]*256+projbuffer [7];
-    sprintf(pulldownmenutitles[0][1],"height:   %5i ",screenheight);
-    screentotal             = projbuffer[ 8]*256+projbuffer[ 9];
-    screenbackground        = projbuffer[10];
-    bgcolor(screenbackground);
-    sprintf(pulldownmenutitles[0][2],"background: %3i ",screenbackground);
-    mc_mb_normal            = projbuffer[11];
-    mc_mb_select            = projbuffer[12];
-    mc_pd_normal            = projbuffer[13];
-    mc_pd_select            = projbuffer[14];
-    mc_menupopup            = projbuffer[15];
-    plotscreencode          = projbuffer[16];
-    plotcolor               = projbuffer[17];
-    plotluminance           = projbuffer[18];
-    plotblink               = projbuffer[19];
-    screenborder            = projbuffer[20];
-    sprintf(pulldownmenutitles[0][3],"border:     %3i ",screenborder);
+    if(lastreadaddress<=(unsigned int)projbuffer) { return 255; }
+    if(!projectmeta_fits(projbuffer)) { return 255; }
+
+    // Load charset, before the screen as in the container
+    if(projbuffer[0]==1)
+    {
+        sprintf(buffer,"%s.chrs",filename);
+        if(TED_Load(buffer,targetdevice,CHARSET) <= CHARSET) { return 255; }
+    }
 
     // Load screen
     sprintf(buffer,"%s.scrn",filename);
-    lastreadaddress = TED_Load(buffer,targetdevice,SCREENMAPBASE);
-    if(lastreadaddress>SCREENMAPBASE)
+    if(TED_Load(buffer,targetdevice,SCREENMAPBASE) <= SCREENMAPBASE) { return 255; }
+
+    return 0;
+}
+
+void loadproject()
+{
+    // Function to load project (metadata, charset and screen) from one container file,
+    // or import it from the separate files of older versions
+    // Charset and metadata are only applied after all data is read and the checksum matches
+
+    unsigned char projbuffer[PROJ_HEADERSIZE];
+    unsigned char* meta = projbuffer+4;
+    unsigned char error = 255;
+    unsigned char damaged = 0;
+    unsigned int end, checksum;
+    char tempfilename[21];
+    int escapeflag;
+  
+    escapeflag = chooseidandfilename("load project",10,".proj");
+
+    windowrestore(0);
+
+    if(escapeflag==-1) { return; }
+
+    sprintf(tempfilename,"%s.proj",filename);
+    if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,tempfilename))
     {
-        windowrestore(0);
-        TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
-        windowsave(0,1,0);
-        menuplacebar();
-        if(showbar) { initstatusbar(); }
+        fileerrormessage(_oserror,0);
+        return;
     }
+    TED_BlankStart();
+    screenmap_setlayout(0);
 
-    // Load charset
-    if(charsetchanged==1)
+    if(cbm_read(SCRN_LFN,projbuffer,PROJ_HEADERSIZE) == PROJ_HEADERSIZE &&
+       projbuffer[0] == PROJ_MAGIC0 && projbuffer[1] == PROJ_MAGIC1 && projbuffer[2] == PROJ_MAGIC2 && projbuffer[3] == PROJ_VERSION)
     {
-        sprintf(buffer,"%s.chrs",filename);
-        TED_Load(buffer,targetdevice,CHARSET);
+        // Container: read charset if changed to free window memory and packed screen from the same stream
+        if(projectmeta_fits(meta))
+        {
+            error = 0;
+            end = SCREENMAPBASE+(meta[4]*256+meta[5])*(meta[6]*256+meta[7])*2+24;
+            if(meta[0]==1 && cbm_read(SCRN_LFN,(void*)windowaddress,128*8) != 128*8) { error = 255; }
+            if(!error)
+            {
+                // From here on the canvas is overwritten, so it is cleared if the data turns out bad
+                if(TED_RLE_Read(SCRN_LFN,SCREENMAPBASE,end) != end) { error = 255; }
+                else
+                {
+                    checksum = TED_Checksum(SCREENMAPBASE,end-SCREENMAPBASE);
+                    if(meta[0]==1) { checksum += TED_Checksum(windowaddress,128*8); }
+                    if(checksum != projbuffer[PROJ_CHECKSUM]*256+projbuffer[PROJ_CHECKSUM+1]) { error = PROJ_CHECKSUMERROR; }
+                }
+                damaged = error;
+            }
+        }
+        cbm_close(SCRN_LFN);
+        if(!error)
+        {
+            if(meta[0]==1) { memcpy((void*)CHARSET,(void*)windowaddress,128*8); }
+            projectmeta_apply(meta);
+        }
     }
+    else
+    {
+        cbm_close(SCRN_LFN);
+        error = loadproject_triple(projbuffer);
+        if(!error) { projectmeta_apply(projbuffer); }
+    }
+
+    screenstride = screenwidth;
+    screenplane = screentotal + 24;
+    screenalign = screenmap_setlayout(screenalign);
+    if(damaged) { screenmapfill(CH_SPACE,COLOR_WHITE); }
+    TED_BlankEnd(screenborder);
+    sprintf(pulldownmenutitles[0][6],"layout: %s ",screenalign?"aligned":" packed");
+    if(!error) { journal_merge(tempfilename); } else { journal_setbase(""); }
+    windowrestore(0);
+    TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
+    windowsave(0,1,0);
+    menuplacebar();
+    if(showbar) { initstatusbar(); }
+    if(error == PROJ_CHECKSUMERROR) { messagepopup("checksum error in project.",0); }
+    else if(error) { fileerrormessage(error,0); }
 }
 
+// Overlay 6: region load and save
+#pragma code-name ("OVERLAY6")
+#pragma rodata-name ("OVERLAY6")
+
+unsigned char region_readrow(unsigned int address, unsigned int length, unsigned int skip)
+{
+    // Function to read a row of region data from the open region file and skip the bytes that do not fit
+    // Input: destination address, number of bytes to read there, number of bytes to skip after that
+    // Output: 1 if read, 0 on error
+
+    unsigned int chunk;
+
+    if(length && cbm_read(SCRN_LFN,(void*)address,length) != (int)length) { return 0; }
+
+    while(skip)
+    {
+        chunk = (skip > 80)? 80 : skip;
+        if(cbm_read(SCRN_LFN,buffer,chunk) != (int)chunk) { return 0; }
+        skip -= chunk;
+    }
+
+    return 1;
+}
+
+void saveregion()
+{
+    // Function to save the selected area as region file, streaming it row by row from the screenmap
+
+    unsigned char header[REGN_HEADERSIZE];
+    unsigned char error = 0;
+    unsigned char overwrite;
+    unsigned int y;
+    int escapeflag;
+
+    if(charsetchanged) { TED_CharsetStandard(charsetlowercase); }
+
+    escapeflag = chooseidandfilename("save region",15,"");
+
+    windowrestore(0);
+
+    if(escapeflag!=-1)
+    {
+        overwrite = checkiffileexists(filename,targetdevice);
+
+        if(overwrite)
+        {
+            // Scratch old file
+            if(overwrite==2)
+            {
+                sprintf(buffer,"s:%s",filename);
+                cmd(targetdevice,buffer);
+            }
+
+            header[0] = REGN_MAGIC0;
+            header[1] = REGN_MAGIC1;
+            header[2] = REGN_MAGIC2;
+            header[3] = REGN_VERSION;
+            header[4] = (select_width>>8) & 0xff;
+            header[5] = select_width & 0xff;
+            header[6] = (select_height>>8) & 0xff;
+            header[7] = select_height & 0xff;
+
+            sprintf(buffer,"%s,p,w",filename);
+            if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,buffer))
+            {
+                error = _oserror;
+            }
+            else
+            {
+                if(cbm_write(SCRN_LFN,header,REGN_HEADERSIZE) != REGN_HEADERSIZE) { error = 255; }
+
+                // Per row the attribute data followed by the character data, stored with the region width as stride
+                TED_BlankStart();
+                for(y=0;y<select_height && !error;y++)
+                {
+                    TED_BlankProgress();
+                    if(cbm_write(SCRN_LFN,(void*)screenmap_attraddr(select_starty+y,select_startx),select_width) != (int)select_width ||
+                       cbm_write(SCRN_LFN,(void*)screenmap_screenaddr(select_starty+y,select_startx),select_width) != (int)select_width)
+                    {
+                        error = 255;
+                    }
+                }
+                TED_BlankEnd(screenborder);
+                cbm_close(SCRN_LFN);
+            }
+            dircache_saved(filename,CBM_T_PRG,error);
+
+            if(error) { fileerrormessage(error,0); }
+        }
+    }
+
+    if(charsetchanged) { TED_CharsetCustom(CHARSET); }
+}
+
+void loadregion()
+{
+    // Function to load a region file with the upper left corner at the cursor position
+    // Parts of the region outside the canvas are skipped
+
+    unsigned char header[REGN_HEADERSIZE];
+    unsigned char error = 0;
+    unsigned int width, height, fitwidth, fitheight, y;
+    unsigned int xpos = screen_col + xoffset;
+    unsigned int ypos = screen_row + yoffset;
+    int escapeflag;
+
+    escapeflag = chooseidandfilename("load region",15,"");
+
+    windowrestore(0);
+
+    if(escapeflag==-1) { return; }
+
+    if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,filename))
+    {
+        fileerrormessage(_oserror,0);
+        return;
+    }
+
+    if(cbm_read(SCRN_LFN,header,REGN_HEADERSIZE) != REGN_HEADERSIZE ||
+       header[0] != REGN_MAGIC0 || header[1] != REGN_MAGIC1 || header[2] != REGN_MAGIC2 || header[3] != REGN_VERSION)
+    {
+        cbm_close(SCRN_LFN);
+        messagepopup("no region file.",0);
+        return;
+    }
+
+    width = header[4]*256+header[5];
+    height = header[6]*256+header[7];
+    fitwidth = (xpos + width > screenwidth)? screenwidth - xpos : width;
+    fitheight = (ypos + height > screenheight)? screenheight - ypos : height;
+
+    // Read rows directly into the screenmap at canvas stride, rows below the canvas are not read
+    TED_BlankStart();
+    for(y=0;y<fitheight && !error;y++)
+    {
+        TED_BlankProgress();
+        if(!region_readrow(screenmap_attraddr(ypos+y,xpos),fitwidth,width-fitwidth) ||
+           !region_readrow(screenmap_screenaddr(ypos+y,xpos),fitwidth,width-fitwidth))
+        {
+            error = 255;
+        }
+    }
+    TED_BlankEnd(screenborder);
+    cbm_close(SCRN_LFN);
+    dirtyrows_mark(ypos,fitheight);
+
+    windowrestore(0);
+    TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
+    windowsave(0,1,0);
+    menuplacebar();
+    if(showbar) { initstatusbar(); }
+
+    if(error) { fileerrormessage(error,0); }
+}
+
+// Overlay 2: screen and charset load and save
+#pragma code-name ("OVERLAY2")
+#pragma rodata-name ("OVERLAY2")
+
 void loadcharset()
 {
     // Function to load charset
@@ -2298,7 +3220,7 @@ void loadcharset()
     unsigned int lastreadaddress;
     int escapeflag;
   
-    escapeflag = chooseidandfilename("load character set",15);
+    escapeflag = chooseidandfilename("load character set",15,"");
 
     windowrestore(0);
 
@@ -2320,7 +3242,7 @@ void savecharset()
     unsigned char error;
     int escapeflag;
   
-    escapeflag = chooseidandfilename("save character set",15);
+    escapeflag = chooseidandfilename("save character set",15,"");
 
     windowrestore(0);
 
@@ -2340,12 +3262,16 @@ void savecharset()
     
 	    // Load from file to memory
 	    error = cbm_k_save(CHARSET,CHARSET+128*8);
-
+        dircache_saved(filename,CBM_T_PRG,error);
 
         if(error) { fileerrormessage(error,0); }
     }
 }
 
+// Overlay 7: background and border color
+#pragma code-name ("OVERLAY7")
+#pragma rodata-name ("OVERLAY7")
+
 void changebackgroundcolor()
 {
     // Function to change background color
@@ -2550,6 +3476,37 @@ void changebordercolor()
     textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));    
 }
 
+// Overlay 9: screen and version info
+#pragma code-name ("OVERLAY9")
+#pragma rodata-name ("OVERLAY9")
+
+void screeninfo()
+{
+    // Function to show screen map dimensions, layout, memory use and the duration of the last heavy operation
+
+    unsigned int used = screenplane + screenstride*screenheight;
+
+    windownew(2,5,13,35,1);
+    revers(1);
+    textcolor(mc_menupopup);
+    cputsxy(4,6,"screen information");
+    sprintf(buffer,"width:  %5u  height: %5u",screenwidth,screenheight);
+    cputsxy(4,8,buffer);
+    sprintf(buffer,"layout: %s  stride: %5u",screenalign?"aligned":" packed",screenstride);
+    cputsxy(4,9,buffer);
+    sprintf(buffer,"memory used: %5u bytes",used);
+    cputsxy(4,11,buffer);
+    sprintf(buffer,"memory free: %5u bytes",MEMORYLIMIT-SCREENMAPBASE-used);
+    cputsxy(4,12,buffer);
+    sprintf(buffer,"last operation: %5lu ms",(unsigned long)TED_blanktime*1000/CLOCKS_PER_SEC);
+    cputsxy(4,14,buffer);
+    cputsxy(4,16,"press a key to continue.");
+    cgetc();
+    windowrestore(0);
+    revers(0);
+    textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));
+}
+
 void versioninfo()
 {
     windownew(2,5,15,35,1);
@@ -2570,6 +3527,745 @@ void versioninfo()
     textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));
 }
 
+// Resident code
+#pragma code-name ("CODE")
+#pragma rodata-name ("RODATA")
+
+// PETSCII color codes for TED colors 0-15, printing them gives the KERNAL default luminance of the color
+const unsigned char petsciicolors[16] = {144,5,28,159,156,30,31,158,129,149,150,151,152,153,154,155};
+
+// Attributes with the KERNAL default luminance that the color codes above print in
+const unsigned char petsciiattributes[16] = {0x00,0x71,0x32,0x63,0x44,0x35,0x46,0x77,0x48,0x29,0x5a,0x6b,0x5c,0x6d,0x2e,0x5f};
+
+void seq_flush()
+{
+    // Write the filled part of the SEQ output block to the open file
+
+    if(seqpos && !seqerror && cbm_write(SCRN_LFN,seqblock,seqpos) != (int)seqpos) { seqerror = 255; }
+    seqpos = 0;
+}
+
+void seq_put(unsigned char petscii)
+{
+    // Add a byte to the SEQ output block, writing the block when full
+
+    seqblock[seqpos++] = petscii;
+    if(seqpos == SEQ_BLOCKSIZE) { seq_flush(); }
+}
+
+// Overlay 4: PETSCII export
+#pragma code-name ("OVERLAY4")
+#pragma rodata-name ("OVERLAY4")
+
+void seq_attribute(unsigned char screencode, unsigned char attribute)
+{
+    // Emit the reverse, color and flash codes needed to print a character, only if they differ from the present state
+
+    unsigned char rvs = screencode & 0x80;
+    unsigned char flash = attribute & 0x80;
+
+    if(rvs != seqrvs)
+    {
+        seq_put(rvs? PETSCII_RVSON : PETSCII_RVSOFF);
+        seqrvs = rvs;
+    }
+    if((attribute & 0x0f) != seqcolor)
+    {
+        seqcolor = attribute & 0x0f;
+        seq_put(petsciicolors[seqcolor]);
+    }
+    if(flash != seqflash)
+    {
+        seq_put(flash? PETSCII_FLASHON : PETSCII_FLASHOFF);
+        seqflash = flash;
+    }
+}
+
+void seq_character(unsigned char screencode, unsigned char escape)
+{
+    // Emit the PETSCII code that prints a screencode, reverse is set by seq_attribute
+
+    screencode &= 0x7f;
+    if(screencode < 32)      { seq_put(screencode+64); }
+    else if(screencode < 64) { seq_put(screencode); }
+    else if(screencode < 96) { seq_put(screencode+128); }
+    else                     { seq_put(screencode+64); }
+
+    // A quote starts quote mode, in which color codes would print as symbols: print a second quote and delete it
+    if(screencode == PETSCII_QUOTE && escape)
+    {
+        seq_put(PETSCII_QUOTE);
+        seq_put(PETSCII_DELETE);
+    }
+}
+
+void exportseq()
+{
+    // Function to export the 40 columns shown from the left of the viewport, for all rows, as a PETSCII SEQ file
+    // Blanks are skipped with cursor right and trailing blanks are not printed. The first character of a row is
+    // reached with return and cursor right, or with cursor down and cursor left or right from the end of the
+    // row above when that is shorter, so indented content does not repeat its indent on every row
+
+    unsigned char error, overwrite, quotelast;
+    unsigned char* chars;
+    unsigned char* attrs;
+    unsigned char column, down, linked;
+    unsigned int y;
+    int x, first, last;
+    int escapeflag;
+
+    escapeflag = chooseidandfilename("export petscii seq",15,"");
+
+    windowrestore(0);
+
+    if(escapeflag==-1) { return; }
+
+    overwrite = checkiffileexists(filename,targetdevice);
+
+    if(overwrite)
+    {
+        // Scratch old file
+        if(overwrite==2)
+        {
+            sprintf(buffer,"s:%s",filename);
+            cmd(targetdevice,buffer);
+        }
+
+        sprintf(buffer,"%s,s,w",filename);
+        if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,buffer))
+        {
+            dircache_invalidate(targetdevice);
+            fileerrormessage(_oserror,0);
+            return;
+        }
+
+        TED_BlankStart();
+        seqpos = 0;
+        seqerror = 0;
+
+        // Start from a cleared screen in known state, color is set by the first character printed
+        seq_put(PETSCII_CLEAR);
+        seq_put(charsetlowercase? PETSCII_LOWERCASE : PETSCII_UPPERCASE);
+        seq_put(PETSCII_RVSOFF);
+        seq_put(PETSCII_FLASHOFF);
+        seqrvs = 0;
+        seqflash = 0;
+        seqcolor = 0xff;
+        column = 0;
+        down = 0;
+        linked = 0;
+
+        for(y=0;y<screenheight && !seqerror;y++)
+        {
+            chars = (unsigned char*)screenmap_screenaddr(y,xoffset);
+            attrs = (unsigned char*)screenmap_attraddr(y,xoffset);
+
+            // Find first and last character that is not a blank, a space in the standard charset shows no color
+            last = 39;
+            while(last >= 0 && chars[last] == CH_SPACE && !charsetchanged) { last--; }
+            first = 0;
+            while(first < last && chars[first] == CH_SPACE && !charsetchanged) { first++; }
+            if(first > 38 && last == 39 && y == screenheight-1 && y >= 24) { first = 38; }
+
+            // Move to the first character from the cursor position left by the rows above
+            if(last >= 0)
+            {
+                // The quote escape of a quote in column 38 wraps into the next row and links it to the row above,
+                // a return would skip the linked row so that one is reached with cursor down
+                if(down && linked)
+                {
+                    seq_put(PETSCII_DOWN);
+                    down--;
+                }
+                if(down && ((first > column)? first-column : column-first) < first)
+                {
+                    for(;down;down--) { seq_put(PETSCII_DOWN); }
+                }
+                else if(down)
+                {
+                    // A return also ends reverse
+                    for(;down;down--) { seq_put(PETSCII_RETURN); }
+                    seqrvs = 0;
+                    column = 0;
+                }
+                for(;column<first;column++) { seq_put(PETSCII_RIGHT); }
+                for(;column>first;column--) { seq_put(PETSCII_LEFT); }
+            }
+
+            for(x=first;x<=last;x++)
+            {
+                // Printing the last column of the bottom screen row would scroll up,
+                // so print it one column to the left and insert the character before it.
+                // A quote there would show the cursor left as a symbol, so it is left out
+                if(x == 38 && last == 39 && y == screenheight-1 && y >= 24)
+                {
+                    quotelast = ((chars[39] & 0x7f) == PETSCII_QUOTE);
+                    if(!quotelast)
+                    {
+                        seq_attribute(chars[39],attrs[39]);
+                        seq_character(chars[39],0);
+                        seq_put(PETSCII_LEFT);
+                    }
+                    if(chars[38] != CH_SPACE || charsetchanged)
+                    {
+                        seq_attribute(chars[38],attrs[38]);
+                        if(!quotelast) { seq_put(PETSCII_INSERT); }
+                        seq_character(chars[38],0);
+                    }
+                    else if(!quotelast)
+                    {
+                        seq_put(PETSCII_INSERT);
+                    }
+                    break;
+                }
+
+                if(chars[x] == CH_SPACE && !charsetchanged)
+                {
+                    seq_put(PETSCII_RIGHT);
+                }
+                else
+                {
+                    seq_attribute(chars[x],attrs[x]);
+                    seq_character(chars[x],1);
+                }
+            }
+
+            // Full rows wrap to the next line by themselves, other rows leave the cursor after their last character
+            if(last == 39)
+            {
+                column = 0;
+                linked = 0;
+            }
+            else
+            {
+                if(last >= 0)
+                {
+                    column = last+1;
+                    linked = (last == 38 && (chars[38] & 0x7f) == PETSCII_QUOTE);
+                }
+                if(y < screenheight-1) { down++; }
+            }
+            TED_BlankProgress();
+        }
+
+        // End on the row below the last row with content, as the rows are moved to
+        if(down && linked)
+        {
+            seq_put(PETSCII_DOWN);
+            down--;
+        }
+        for(;down;down--) { seq_put(PETSCII_RETURN); }
+
+        seq_flush();
+        cbm_close(SCRN_LFN);
+        TED_BlankEnd(screenborder);
+
+        error = seqerror;
+        dircache_saved(filename,CBM_T_SEQ,error);
+        if(error) { fileerrormessage(error,0); }
+    }
+}
+
+// Overlay 11: write mode and PETSCII import
+#pragma code-name ("OVERLAY11")
+#pragma rodata-name ("OVERLAY11")
+
+void importseq()
+{
+    // Function to import a PETSCII SEQ file at the cursor position, acting on control codes as the screen editor would
+    // Lines wrap at 40 columns from the cursor column, parts outside the canvas are skipped
+
+    unsigned char table[256];
+    unsigned char attribute = TED_Attribute(plotcolor,plotluminance,plotblink);
+    unsigned char rvs = 0;
+    unsigned char quote = 0;
+    unsigned char inserts = 0;
+    unsigned char wrapped = 0;
+    unsigned char error = 0;
+    unsigned char petscii, screencode, col, x;
+    unsigned char* chars;
+    unsigned char* attrs;
+    unsigned int startx = screen_col + xoffset;
+    unsigned int starty = screen_row + yoffset;
+    unsigned int width = screenwidth - startx;
+    unsigned int row = 0;
+    unsigned int maxrow = 0;
+    unsigned int pointerrow = 0xffff;
+    unsigned int y;
+    int read, pos;
+    int escapeflag;
+
+    if(charsetchanged) { TED_CharsetStandard(charsetlowercase); }
+    escapeflag = chooseidandfilename("import petscii seq",15,"");
+    windowrestore(0);
+    if(charsetchanged) { TED_CharsetCustom(CHARSET); }
+
+    if(escapeflag==-1) { return; }
+
+    sprintf(buffer,"%s,s,r",filename);
+    if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,buffer))
+    {
+        fileerrormessage(_oserror,1);
+        return;
+    }
+
+    // Conversion table for all PETSCII codes, control codes map to their reverse symbol as shown in quote mode
+    petscii = 0;
+    do
+    {
+        table[petscii] = TED_PetsciiToScreenCode(petscii);
+    } while(++petscii);
+
+    if(width > 40) { width = 40; }
+    col = 0;
+
+    TED_BlankStart();
+    while((read = cbm_read(SCRN_LFN,seqblock,SEQ_BLOCKSIZE)) > 0)
+    {
+        TED_BlankProgress();
+        for(pos=0;pos<read;pos++)
+        {
+            petscii = seqblock[pos];
+            if(row != pointerrow)
+            {
+                chars = (unsigned char*)screenmap_screenaddr(starty+row,startx);
+                attrs = (unsigned char*)screenmap_attraddr(starty+row,startx);
+                pointerrow = row;
+            }
+
+            // Control codes act, unless quote or insert mode shows them as symbols,
+            // delete still acts in quote mode but is shown as symbol in insert mode
+            if((petscii & 0x7f) < 32 && ((!quote && !inserts) || petscii == PETSCII_RETURN || petscii == PETSCII_SHIFTRETURN || (petscii == PETSCII_DELETE && !inserts)))
+            {
+                switch (petscii)
+                {
+                case PETSCII_RETURN:
+                case PETSCII_SHIFTRETURN:
+                    col = 0;
+                    row++;
+                    rvs = quote = inserts = wrapped = 0;
+                    break;
+
+                case PETSCII_RVSON:
+                    rvs = 0x80;
+                    break;
+
+                case PETSCII_RVSOFF:
+                    rvs = 0;
+                    break;
+
+                case PETSCII_FLASHON:
+                    attribute |= 0x80;
+                    break;
+
+                case PETSCII_FLASHOFF:
+                    attribute &= 0x7f;
+                    break;
+
+                case PETSCII_RIGHT:
+                    if(++col == 40) { col = 0; row++; wrapped = 1; }
+                    break;
+
+                case PETSCII_LEFT:
+                    if(col) { col--; }
+                    else if(row) { col = 39; row--; }
+                    break;
+
+                case PETSCII_DOWN:
+                    row++;
+                    wrapped = 0;
+                    break;
+
+                case PETSCII_UP:
+                    if(row) { row--; }
+                    wrapped = 0;
+                    break;
+
+                case PETSCII_HOME:
+                    col = 0;
+                    row = 0;
+                    wrapped = 0;
+                    break;
+
+                case PETSCII_CLEAR:
+                    for(y=starty;y<starty+25 && y<screenheight;y++)
+                    {
+                        memset((void*)screenmap_screenaddr(y,startx),CH_SPACE,width);
+                        memset((void*)screenmap_attraddr(y,startx),attribute & 0x7f,width);
+                    }
+                    if(maxrow < 24) { maxrow = 24; }
+                    col = 0;
+                    row = 0;
+                    wrapped = 0;
+                    break;
+
+                case PETSCII_LOWERCASE:
+                case PETSCII_UPPERCASE:
+                    charsetlowercase = (petscii == PETSCII_LOWERCASE);
+                    break;
+
+                case PETSCII_DELETE:
+                    // Remove character left of the cursor and close the gap in the line,
+                    // at the start of a wrapped line this is the last column of the line above
+                    if(!col && wrapped)
+                    {
+                        row--;
+                        col = 40;
+                        wrapped = 0;
+                        chars = (unsigned char*)screenmap_screenaddr(starty+row,startx);
+                        attrs = (unsigned char*)screenmap_attraddr(starty+row,startx);
+                        pointerrow = row;
+                    }
+                    if(col && starty+row < screenheight)
+                    {
+                        col--;
+                        for(x=col;x+1<width;x++)
+                        {
+                            chars[x] = chars[x+1];
+                            attrs[x] = attrs[x+1];
+                        }
+                        if(col < width)
+                        {
+                            chars[width-1] = CH_SPACE;
+                            attrs[width-1] = attribute & 0x7f;
+                        }
+                        if(row > maxrow) { maxrow = row; }
+                    }
+                    break;
+
+                case PETSCII_INSERT:
+                    // Open a gap at the cursor by shifting the rest of the line right,
+                    // the next characters fill the gap and show control codes as symbols
+                    if(starty+row < screenheight && col < width)
+                    {
+                        for(x=width-1;x>col;x--)
+                        {
+                            chars[x] = chars[x-1];
+                            attrs[x] = attrs[x-1];
+                        }
+                        chars[col] = CH_SPACE;
+                        if(row > maxrow) { maxrow = row; }
+                    }
+                    inserts++;
+                    break;
+
+                default:
+                    // Color codes set the color with its default luminance, keeping flash
+                    for(x=0;x<16;x++)
+                    {
+                        if(petsciicolors[x] == petscii)
+                        {
+                            attribute = (attribute & 0x80) | petsciiattributes[x];
+                        }
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                // Place printable character, or control code shown as symbol
+                screencode = table[petscii] | rvs;
+                if(petscii == PETSCII_QUOTE) { quote = !quote; }
+                if(inserts) { inserts--; }
+                if(starty+row < screenheight && col < width)
+                {
+                    chars[col] = screencode;
+                    attrs[col] = attribute;
+                    if(row > maxrow) { maxrow = row; }
+                }
+                if(++col == 40) { col = 0; row++; wrapped = 1; }
+            }
+        }
+    }
+    if(read < 0) { error = 255; }
+    cbm_close(SCRN_LFN);
+    TED_BlankEnd(screenborder);
+
+    // Redraw once with the imported text
+    if(!charsetchanged) { TED_CharsetStandard(charsetlowercase); }
+    dirtyrows_mark(starty,(starty+maxrow < screenheight)? maxrow+1 : screenheight-starty);
+    TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
+    if(showbar) { initstatusbar(); }
+
+    if(error) { fileerrormessage(error,1); }
+}
+
+// Overlay 10: data export
+#pragma code-name ("OVERLAY10")
+#pragma rodata-name ("OVERLAY10")
+
+void export_text(char* text)
+{
+    // Write text for the assembler on the PC: letters and return converted from PETSCII to ASCII
+
+    unsigned char c;
+
+    while((c = *text++))
+    {
+        if(c >= 0x41 && c <= 0x5a)      { c += 0x20; }
+        else if(c >= 0xc1 && c <= 0xda) { c -= 0x80; }
+        else if(c == PETSCII_RETURN)    { c = 0x0a; }
+        seq_put(c);
+    }
+}
+
+void export_byte(unsigned char value)
+{
+    // Write a data byte, as is or in lines of 16 values for the assembler
+
+    if(!exportasm)
+    {
+        seq_put(value);
+        return;
+    }
+    sprintf(buffer,exportcount? ",$%02x" : "\n    .byte $%02x",value);
+    export_text(buffer);
+    if(++exportcount == 16) { exportcount = 0; }
+}
+
+void export_rle(unsigned int address, unsigned int length)
+{
+    // Write data RLE packed, blockwise as TED_RLE_Write()
+
+    unsigned char block[RLE_WORSTCASE(RLE_STREAMBLOCK)];
+    unsigned int chunk, packed, x;
+
+    while(length && !seqerror)
+    {
+        chunk = (length > RLE_STREAMBLOCK)? RLE_STREAMBLOCK : length;
+        packed = TED_RLE_Pack(address,(unsigned int)block,chunk) - 1;
+        for(x=0;x<packed;x++) { export_byte(block[x]); }
+        TED_BlankProgress();
+        address += chunk;
+        length -= chunk;
+    }
+    export_byte(RLE_END);
+}
+
+unsigned char export_tiles(unsigned int address, unsigned int width, unsigned int height, char* label)
+{
+    // Write a plane as map of 2x2 tiles, followed by the tile table as four arrays of top left, top right,
+    // bottom left and bottom right characters. Cells outside the plane at odd sizes are 0
+    // Output: error code, 0 if no error
+
+    unsigned char* table = malloc(EXPORT_MAXTILES*4);
+    unsigned char* row0;
+    unsigned char* row1;
+    unsigned int count = 0;
+    unsigned int tx, ty, t;
+    unsigned char tl, tr, bl, br;
+
+    if(!table) { return EXPORT_MEMORYERROR; }
+
+    for(ty=0;ty<height && !seqerror;ty+=2)
+    {
+        row0 = (unsigned char*)address+ty*width;
+        row1 = row0+width;
+        for(tx=0;tx<width;tx+=2)
+        {
+            tl = row0[tx];
+            tr = (tx+1 < width)? row0[tx+1] : 0;
+            bl = (ty+1 < height)? row1[tx] : 0;
+            br = (tx+1 < width && ty+1 < height)? row1[tx+1] : 0;
+
+            // Find tile or add it
+            for(t=0;t<count;t++)
+            {
+                if(table[t] == tl && table[t+EXPORT_MAXTILES] == tr && table[t+EXPORT_MAXTILES*2] == bl && table[t+EXPORT_MAXTILES*3] == br) { break; }
+            }
+            if(t == count)
+            {
+                if(count == EXPORT_MAXTILES)
+                {
+                    free(table);
+                    return EXPORT_TILEERROR;
+                }
+                table[t] = tl;
+                table[t+EXPORT_MAXTILES] = tr;
+                table[t+EXPORT_MAXTILES*2] = bl;
+                table[t+EXPORT_MAXTILES*3] = br;
+                count++;
+            }
+            export_byte(t);
+        }
+        TED_BlankProgress();
+    }
+
+    if(exportasm)
+    {
+        sprintf(buffer,"\n%s_tilecount = %u\n%s_tiles:",label,count,label);
+        export_text(buffer);
+        exportcount = 0;
+    }
+    for(t=0;t<count*4;t++)
+    {
+        export_byte(table[(t/count)*EXPORT_MAXTILES+(t%count)]);
+    }
+
+    free(table);
+    return 0;
+}
+
+unsigned char export_file(char* name, char* label, char* description, unsigned int address, unsigned int width, unsigned int height, unsigned char encoding)
+{
+    // Write a plane or the charset to an export file
+    // Output: error code, 0 if no error
+
+    unsigned int length;
+    unsigned char error;
+
+    sprintf(buffer,"%s,s,w",name);
+    if(cbm_open(SCRN_LFN,targetdevice,SCRN_LFN,buffer)) { return _oserror; }
+
+    seqpos = 0;
+    seqerror = 0;
+    exportcount = 0;
+    if(exportasm)
+    {
+        sprintf(buffer,"; tedse export of %s: %s, %ux%u, %s\n",filename,description,width,height,(encoding == EXPORT_RAW)? "raw" : (encoding == EXPORT_RLE)? "rle" : "tiles");
+        export_text(buffer);
+        sprintf(buffer,"%s_width = %u\n%s_height = %u\n",label,width,label,height);
+        export_text(buffer);
+        sprintf(buffer,"%s:",label);
+        export_text(buffer);
+    }
+
+    error = 0;
+    if(encoding == EXPORT_TILES)
+    {
+        error = export_tiles(address,width,height,label);
+    }
+    else if(encoding == EXPORT_RLE)
+    {
+        export_rle(address,width*height);
+    }
+    else
+    {
+        for(length=width*height;length && !seqerror;length--)
+        {
+            export_byte(PEEK(address++));
+        }
+    }
+    if(exportasm) { export_text("\n"); }
+
+    seq_flush();
+    cbm_close(SCRN_LFN);
+    if(!error) { error = seqerror; }
+
+    // Remove a partly written file
+    if(error == EXPORT_TILEERROR || error == EXPORT_MEMORYERROR)
+    {
+        sprintf(buffer,"s:%s",name);
+        cmd(targetdevice,buffer);
+    }
+    else
+    {
+        dircache_saved(name,CBM_T_SEQ,error);
+    }
+    return error;
+}
+
+void exportdata()
+{
+    // Function to export the screen map and the charset as data to include in own programs,
+    // as assembly source or binary, raw or packed. Decoders are in tools/tedsedecode.s
+
+    unsigned char key, encoding, error, x;
+    unsigned char overwrite[3];
+    char names[3][28];
+    char label[22];
+    char sublabel[26];
+    char* suffix;
+    char* ptr;
+    int escapeflag;
+
+    escapeflag = chooseidandfilename("export data",10,"");
+
+    if(escapeflag==-1)
+    {
+        windowrestore(0);
+        return;
+    }
+
+    revers(1);
+    textcolor(mc_menupopup);
+    cputsxy(4,12,"a: assembly source  b: binary");
+    do
+    {
+        key = cgetc();
+    } while (key != 'a' && key != 'b' && key != CH_ESC && key != CH_STOP);
+    if(key == CH_ESC || key == CH_STOP) { windowrestore(0); return; }
+    exportasm = (key == 'a');
+
+    cputsxy(4,13,"r: raw  l: rle  t: 2x2 tiles");
+    do
+    {
+        key = cgetc();
+        if(key == 't' && screenwidth > 255) { cputsxy(4,14,"tiles need width below 256."); }
+    } while (key != 'r' && key != 'l' && (key != 't' || screenwidth > 255) && key != CH_ESC && key != CH_STOP);
+    windowrestore(0);
+    revers(0);
+    textcolor(TED_Attribute(plotcolor,plotluminance,plotblink));
+    if(key == CH_ESC || key == CH_STOP) { return; }
+    encoding = (key == 'r')? EXPORT_RAW : (key == 'l')? EXPORT_RLE : EXPORT_TILES;
+
+    // Label for the assembler from the filename
+    strcpy(label,filename);
+    for(ptr=label;*ptr;ptr++)
+    {
+        if(!((*ptr >= 0x41 && *ptr <= 0x5a) || (*ptr >= 0xc1 && *ptr <= 0xda) || (*ptr >= '0' && *ptr <= '9'))) { *ptr = '_'; }
+    }
+    if(label[0] >= '0' && label[0] <= '9') { memmove(label+1,label,strlen(label)+1); label[0] = '_'; }
+
+    // Ask all overwrite confirmations first, no dialogue is visible while the screen is blanked
+    suffix = exportasm? ".s" : "";
+    sprintf(names[0],"%s.chr%s",filename,suffix);
+    sprintf(names[1],"%s.atr%s",filename,suffix);
+    sprintf(names[2],"%s.set%s",filename,suffix);
+    for(x=0;x<3;x++)
+    {
+        overwrite[x] = (x < 2 || charsetchanged)? checkiffileexists(names[x],targetdevice) : 0;
+        if(x < 2 && !overwrite[x]) { return; }
+    }
+    for(x=0;x<3;x++)
+    {
+        if(overwrite[x]==2)
+        {
+            sprintf(buffer,"s:%s",names[x]);
+            cmd(targetdevice,buffer);
+        }
+    }
+
+    // Files are written from packed layout
+    TED_BlankStart();
+    screenmap_setlayout(0);
+
+    sprintf(sublabel,"%s_chr",label);
+    error = export_file(names[0],sublabel,"characters",SCREENMAPBASE+screentotal+24,screenwidth,screenheight,encoding);
+    if(!error)
+    {
+        sprintf(sublabel,"%s_atr",label);
+        error = export_file(names[1],sublabel,"attributes",SCREENMAPBASE,screenwidth,screenheight,encoding);
+    }
+    if(!error && overwrite[2])
+    {
+        // Tiles make no sense for character definitions, so the charset is RLE packed instead
+        sprintf(sublabel,"%s_set",label);
+        error = export_file(names[2],sublabel,"charset",CHARSET,8,128,(encoding == EXPORT_TILES)? EXPORT_RLE : encoding);
+    }
+
+    screenmap_setlayout(screenalign);
+    TED_BlankEnd(screenborder);
+
+    if(error == EXPORT_TILEERROR) { messagepopup("too many different tiles.",0); }
+    else if(error == EXPORT_MEMORYERROR) { messagepopup("not enough memory.",0); }
+    else if(error) { fileerrormessage(error,0); }
+}
+
+// Overlay 1: character editor
+#pragma code-name ("OVERLAY1")
+#pragma rodata-name ("OVERLAY1")
+
 void chareditor()
 {
     unsigned char x,y,char_screencode,key;
@@ -2882,11 +4578,15 @@ void chareditor()
     strcpy(programmode,"main");
 }
 
+// Resident code
+#pragma code-name ("CODE")
+#pragma rodata-name ("RODATA")
+
 void mainmenuloop()
 {
     // Function for main menu selection loop
 
-    unsigned char menuchoice;
+    unsigned char menuchoice, newalign;
     
     windowsave(0,1,1);
 
@@ -2897,25 +4597,29 @@ void mainmenuloop()
         switch (menuchoice)
         {
         case 11:
+            loadoverlay(OVERLAY_RESIZE);
             resizewidth();
             break;
 
         case 12:
+            loadoverlay(OVERLAY_RESIZE);
             resizeheight();
             break;
         
         case 13:
+            loadoverlay(OVERLAY_COLORS);
             changebackgroundcolor();
             break;
 
         case 14:
+            loadoverlay(OVERLAY_COLORS);
             changebordercolor();
             break;
 
         case 15:
             screenmapfill(CH_SPACE,COLOR_WHITE);
             windowrestore(0);
-            TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+            TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
             windowsave(0,1,0);
             menuplacebar();
             if(showbar) { initstatusbar(); }
@@ -2924,41 +4628,97 @@ void mainmenuloop()
         case 16:
             screenmapfill(plotscreencode,TED_Attribute(plotcolor,plotluminance, plotblink));
             windowrestore(0);
-            TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,0,0,40,25);
+            TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
+            windowsave(0,1,0);
+            menuplacebar();
+            if(showbar) { initstatusbar(); }
+            break;
+
+        case 17:
+            TED_BlankStart();
+            newalign = screenmap_setlayout(!screenalign);
+            TED_BlankEnd(screenborder);
+            if(newalign == screenalign)
+            {
+                messagepopup("not enough memory for layout.",1);
+                break;
+            }
+            screenalign = !screenalign;
+            sprintf(pulldownmenutitles[0][6],"layout: %s ",screenalign?"aligned":" packed");
+            windowrestore(0);
+            TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,0,0,40,25);
             windowsave(0,1,0);
             menuplacebar();
             if(showbar) { initstatusbar(); }
             break;
 
         case 21:
+            loadoverlay(OVERLAY_FILE);
             savescreenmap();
             break;
 
         case 22:
+            loadoverlay(OVERLAY_FILE);
             loadscreenmap();
             break;
         
         case 23:
+            loadoverlay(OVERLAY_PROJECT);
             saveproject();
             break;
         
         case 24:
+            loadoverlay(OVERLAY_PROJECT);
             loadproject();
             break;
+
+        case 25:
+            loadoverlay(OVERLAY_REGION);
+            loadregion();
+            break;
+
+        case 26:
+            autosave = !autosave;
+            sprintf(pulldownmenutitles[1][5],"autosave:   %s ",autosave?" on":"off");
+            journaltime = clock();
+            break;
         
+        case 27:
+            loadoverlay(OVERLAY_SEQEXPORT);
+            exportseq();
+            break;
+
+        case 28:
+            loadoverlay(OVERLAY_DATAEXPORT);
+            exportdata();
+            break;
+
         case 31:
+            loadoverlay(OVERLAY_FILE);
             loadcharset();
             break;
         
         case 32:
+            loadoverlay(OVERLAY_FILE);
             savecharset();
             break;
 
         case 41:
-            versioninfo();
+            loadoverlay(OVERLAY_INFO);
+            screeninfo();
             break;
 
         case 42:
+            loadoverlay(OVERLAY_INFO);
+            versioninfo();
+            break;
+
+        case 43:
+            TED_blankmode = (TED_blankmode == BLANK_PROGRESS)? BLANK_OFF : TED_blankmode+1;
+            sprintf(pulldownmenutitles[3][2],"blank: %9s",(TED_blankmode == BLANK_OFF)? "off" : (TED_blankmode == BLANK_ON)? "on" : "progress");
+            break;
+
+        case 44:
             appexit = 1;
             menuchoice = 99;
             break;
@@ -2990,6 +4750,8 @@ void main()
     screenwidth = 40;
     screenheight = 25;
     screentotal = screenwidth*screenheight;
+    screenstride = screenwidth;
+    screenplane = screentotal + 24;
     screenbackground = 0;
     screenborder = 0;
     plotscreencode = 0;
@@ -3016,13 +4778,18 @@ void main()
     TED_Init();
     TED_CharsetStandard(0);
 
-    // Load and show title screen
-    printcentered("load title screen",10,24,20);
-    TED_Load("tedse.tscr",bootdevice,COLORMEMORY);
+    // Load and show title screen, visual PETSCII map and help screens from asset bundle
+    printcentered("load startup data",10,24,20);
+    if(!loadassetbundle())
+    {
+        // Fall back to separate files if no bundle is found
+        printcentered("load title screen",10,24,20);
+        TED_Load("tedse.tscr",bootdevice,COLORMEMORY);
 
-    // Load visual PETSCII map mapping data
-    printcentered("load palette map",10,24,20);
-    TED_Load("tedse.petv",bootdevice,PETSCIIMAP);
+        // Load visual PETSCII map mapping data
+        printcentered("load palette map",10,24,20);
+        TED_Load("tedse.petv",bootdevice,PETSCIIMAP);
+    }
 
     // Clear screen map in bank 1 with spaces in text color white
     screenmapfill(CH_SPACE,COLOR_WHITE);
@@ -3045,6 +4812,7 @@ void main()
 
     do
     {
+        if(autosave) { journal_append(); }
         if(showbar) { printstatusbar(); }
         key = cgetc();
 
@@ -3127,18 +4895,20 @@ void main()
 
         // Character eddit mode
         case 'e':
+            loadoverlay(OVERLAY_CHAREDIT);
             chareditor();
             break;
 
         // Palette for character selection
         case 'p':
+            loadoverlay(OVERLAY_PALETTE);
             palette();
             break;
 
         // Grab underlying character and attributes
         case 'g':
-            plotscreencode = PEEK(screenmap_screenaddr(screen_row+yoffset,screen_col+xoffset,screenwidth,screenheight));
-            newval = PEEK(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset,screenwidth));
+            plotscreencode = PEEK(screenmap_screenaddr(screen_row+yoffset,screen_col+xoffset));
+            newval = PEEK(screenmap_attraddr(screen_row+yoffset,screen_col+xoffset));
             plotluminance = newval/16;
             plotcolor = newval%16;
             textcolor(newval);
@@ -3147,27 +4917,42 @@ void main()
 
         // Write mode: type in screencodes
         case 'w':
+            loadoverlay(OVERLAY_WRITE);
             writemode();
             break;
         
         // Color mode: type colors
         case 'c':
+            loadoverlay(OVERLAY_PALETTE);
             colorwrite();
             break;
 
         // Line and box mode
         case 'l':
+            loadoverlay(OVERLAY_DRAW);
             lineandbox(1);
             break;
 
         // Move mode
         case 'm':
+            loadoverlay(OVERLAY_DRAW);
             movemode();
             break;
 
         // Select mode
         case 's':
-            selectmode();
+            loadoverlay(OVERLAY_DRAW);
+            if(selectmode()=='w')
+            {
+                loadoverlay(OVERLAY_REGION);
+                saveregion();
+            }
+            break;
+
+        // Flood fill mode
+        case 'f':
+            loadoverlay(OVERLAY_FILL);
+            fillmode();
             break;
 
         // Try
@@ -3197,7 +4982,7 @@ void main()
             screen_col = 0;
             yoffset = 0;
             xoffset = 0;
-            TED_CopyViewPortToTED(SCREENMAPBASE,screenwidth,screenheight,xoffset,yoffset,screen_col,screen_row,40,25);
+            TED_CopyViewPortToTED(SCREENMAPBASE,screenstride,screenplane,xoffset,yoffset,screen_col,screen_row,40,25);
             if(showbar) { initstatusbar(); }
             gotoxy(screen_col,screen_row);
             TED_Plot(screen_row,screen_col,plotscreencode,TED_Attribute(plotcolor, plotluminance,plotblink));
@@ -0,0 +1,49 @@
+; TED Screen Editor
+; Screen editor for the Commodore Plus/4
+; Written in 2022 by Xander Mol
+
+; https://github.com/xahmol/TEDScreenEdit
+; https://www.idreamtin8bits.com/
+
+; Load address headers for the code overlay files
+
+	.import		__OVERLAYSTART__
+
+	.segment	"OVL1ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL2ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL3ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL4ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL5ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL6ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL7ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL8ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL9ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL10ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL11ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL12ADDR"
+	.addr		__OVERLAYSTART__
+
+	.segment	"OVL13ADDR"
+	.addr		__OVERLAYSTART__
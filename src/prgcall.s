@@ -0,0 +1,274 @@
+; Assembly for callable output of TEDSE2PRG generator
+;
+; Shows a 40x25 TEDSE screen from another program and returns, without BASIC or kernal calls.
+; The code only uses relative branches and zero page pointers, so it runs at any address.
+; The generator sets the address of the data block directly after the code in the two
+; immediate loads at blockptr, for the load address chosen when generating.
+;
+; Entry points, relative to the load address:
+;   +0  show:    unpack the screen and charset, set the TED registers and return
+;   +3  restore: set the TED charset, video base and colors as they were before show,
+;                does nothing if show was not called since the last restore
+; Both return with carry clear and preserve the zero page they use ($D8-$DE).
+; A, X, Y and the flags are not preserved. Interrupts are left as they are.
+
+	; System addresses
+	TED_RAMSELECT       	= $FF12     ; TED data fetch ROM/RAM select (on bit 2)
+	TED_CHARBASE        	= $FF13     ; TED Character data base address (ob bit 2-7)
+	TED_VIDEOBASE			= $FF14		; TED color and screen memory base address (on bit 3-7)
+	TED_BGCOLOR				= $FF15		; TED background color and luminance register
+	TED_BORDERCOLOR			= $FF19		; TED border color and luminance register
+
+    ; Zero page addresses, saved on the stack and restored on return
+	ZP1						= $D8		; Source pointer
+	ZP2						= $D9
+	ZP3						= $DA		; Destination pointer
+	ZP4						= $DB
+	ZP5						= $DC		; Data block pointer
+	ZP6						= $DD
+	ZP7						= $DE		; Unpack stage, then temporary
+
+	; Offsets in data block
+	BLOCK_SCREEN			= 0			; High byte of 2K aligned screen: colors at start, characters $0400 further
+	BLOCK_CHARSET			= 1			; High byte of 1K aligned charset, 0 for ROM charset
+	BLOCK_LOWER				= 2			; Lowercase flag for ROM charset
+	BLOCK_BGCOLOR			= 3			; Background color
+	BLOCK_BORDER			= 4			; Border color
+	BLOCK_SAVED				= 5			; TED registers saved by show: $FF12, $FF13, $FF14, $FF15, $FF19
+	BLOCK_SHOWN				= 10		; Set by show when the registers are saved, cleared by restore
+	BLOCK_DATA				= 11		; RLE packed screen, followed by RLE packed charset if set
+
+    ; Segment to store code in
+    .segment    "PRGCALL"
+
+    ; Load address
+    .word $1001
+
+	; Entry points
+show:
+	clc									; Carry clear selects show
+	bcc entry
+restore:
+	sec									; Carry set selects restore
+entry:
+	ldx #$06							; Save zero page, flags are not changed
+savezp:
+	lda ZP1,x
+	pha
+	dex
+	bpl savezp
+blockptr:
+	lda #$00							; Set by generator: low byte of data block address
+	sta ZP5
+	lda #$00							; Set by generator: high byte of data block address
+	sta ZP6
+	bcc saveted							; Branch to show
+
+	; Restore TED registers, only the bits set by show and only if show saved them
+	ldy #BLOCK_SHOWN
+	lda (ZP5),y
+	beq restore_done					; Branch if nothing saved
+	lda #$00							; Clear flag, registers are restored once
+	sta (ZP5),y
+	ldy #BLOCK_SAVED
+	lda TED_RAMSELECT					; ROM/RAM select for charset
+	and #$FB
+	sta ZP7
+	lda (ZP5),y
+	and #$04
+	ora ZP7
+	sta TED_RAMSELECT
+	iny
+	lda TED_CHARBASE					; Charset base address
+	and #$03
+	sta ZP7
+	lda (ZP5),y
+	and #$FC
+	ora ZP7
+	sta TED_CHARBASE
+	iny
+	lda (ZP5),y							; Video base
+	sta TED_VIDEOBASE
+	iny
+	lda (ZP5),y							; Background color
+	sta TED_BGCOLOR
+	iny
+	lda (ZP5),y							; Border color
+	sta TED_BORDERCOLOR
+restore_done:
+	ldx #$00							; Restore zero page and return, show is too far to branch to its end
+restore_zp:
+	pla
+	sta ZP1,x
+	inx
+	cpx #$07
+	bne restore_zp
+	clc									; Return with carry clear
+	rts
+
+	; Save TED registers for restore
+saveted:
+	ldy #BLOCK_SAVED
+	lda TED_RAMSELECT
+	sta (ZP5),y
+	iny
+	lda TED_CHARBASE
+	sta (ZP5),y
+	iny
+	lda TED_VIDEOBASE
+	sta (ZP5),y
+	iny
+	lda TED_BGCOLOR
+	sta (ZP5),y
+	iny
+	lda TED_BORDERCOLOR
+	sta (ZP5),y
+	iny									; Set flag that registers are saved
+	lda #$01
+	sta (ZP5),y
+
+	; Unpack screen to screen memory
+	lda #$00							; Stage 0 is screen
+	sta ZP7
+	sta ZP3								; Destination is start of screen
+	ldy #BLOCK_SCREEN
+	lda (ZP5),y
+	sta ZP4
+	clc									; Source is packed data in block
+	lda ZP5
+	adc #BLOCK_DATA
+	sta ZP1
+	lda ZP6
+	adc #$00
+	sta ZP2
+
+	; Unpack RLE stream from source in ZP1/ZP2 pointer to destination in ZP3/ZP4 pointer,
+	; same format as TED_RLE_Unpack_core in ted_core_assembly.s
+unpack:
+	ldy #$00							; Set index to control byte
+	lda (ZP1),y							; Load control byte
+	cmp #$ff							; Check for end marker
+	beq unpack_end						; Branch to end if end marker found
+	cmp #$80							; Check for run or literal
+	bcs unpack_run						; Branch if run
+
+	; Literal: copy (value+1) bytes
+	tax									; Set X counter at count minus 1
+	inc ZP1								; Increase source pointer past control byte
+	bne unpack_litloop					; Skip high byte if no page crossed
+	inc ZP2								; Increase high byte of source pointer
+unpack_litloop:
+	lda (ZP1),y							; Load literal byte
+	sta (ZP3),y							; Store at destination
+	iny									; Increase index
+	dex									; Decrease counter
+	bpl unpack_litloop					; Loop until counter past zero
+	tya									; Add count to source
+	clc
+	adc ZP1
+	sta ZP1
+	bcc unpack_adddest
+	inc ZP2
+	bcs unpack_adddest					; Carry still set, always branch to add count to destination
+
+	; Run: repeat next byte (value-$7E) times
+unpack_run:
+	sbc #$7f							; Subtract with carry set for count minus 1
+	tax									; Set X counter at count minus 1
+	ldy #$01							; Set index to value byte
+	lda (ZP1),y							; Load value to repeat
+	ldy #$00							; Set index to start of destination
+unpack_runloop:
+	sta (ZP3),y							; Store value at destination
+	iny									; Increase index
+	dex									; Decrease counter
+	bpl unpack_runloop					; Loop until counter past zero
+	clc									; Skip control and value byte
+	lda ZP1
+	adc #$02
+	sta ZP1
+	bcc unpack_adddest
+	inc ZP2
+
+unpack_adddest:
+	tya									; Add count to destination
+	clc
+	adc ZP3
+	sta ZP3
+	bcc unpack
+	inc ZP4
+	bcs unpack							; Carry still set, always branch to next control byte
+
+unpack_end:
+	inc ZP1								; Skip end marker, the charset stream follows
+	bne unpack_next
+	inc ZP2
+unpack_next:
+	lda ZP7								; Check if charset is unpacked already
+	bne setcharset
+	inc ZP7								; Stage 1 is charset
+	ldy #BLOCK_CHARSET					; Check if there is a charset
+	lda (ZP5),y
+	beq setcharset						; Branch if not
+	sta ZP4								; Destination is start of charset
+	lda #$00
+	sta ZP3
+	beq unpack							; Always branch to unpack charset
+
+	; Set charset from RAM or ROM
+setcharset:
+	ldy #BLOCK_CHARSET
+	lda (ZP5),y
+	beq romcharset						; Branch if ROM charset
+	lda TED_CHARBASE					; Set charset address bits
+	and #$03
+	ora (ZP5),y
+	sta TED_CHARBASE
+	lda TED_RAMSELECT					; Clear bit 2 to fetch charset from RAM
+	and #$FB
+	sta TED_RAMSELECT
+	clv									; Always branch to show screen
+	bvc setscreen
+romcharset:
+	ldy #BLOCK_LOWER					; ROM charset at $D000, lowercase at $D400
+	lda (ZP5),y
+	asl a
+	asl a
+	ora #$D0
+	sta ZP7
+	lda TED_CHARBASE
+	and #$03
+	ora ZP7
+	sta TED_CHARBASE
+	lda TED_RAMSELECT					; Set bit 2 to fetch charset from ROM
+	ora #$04
+	sta TED_RAMSELECT
+
+	; Show screen with its colors
+setscreen:
+	lda TED_VIDEOBASE					; Set video base address bits
+	and #$07
+	ldy #BLOCK_SCREEN
+	ora (ZP5),y
+	sta TED_VIDEOBASE
+	ldy #BLOCK_BGCOLOR
+	lda (ZP5),y
+	sta TED_BGCOLOR
+	iny
+	lda (ZP5),y
+	sta TED_BORDERCOLOR
+
+	; Restore zero page and return
+	ldx #$00
+show_zp:
+	pla
+	sta ZP1,x
+	inx
+	cpx #$07
+	bne show_zp
+	clc									; Return with carry clear
+	rts
+
+	; Data block, the packed screen and charset are added by the generator
+block:
+	.res 11
@@ -4,17 +4,27 @@
 	NORSCREEN				= $D888		; NORSCREEN kernal routine to set normal screen, clear screen and cursor on home
 	TED_RAMSELECT       	= $FF12     ; TED data fetch ROM/RAM select (on bit 2)
 	TED_CHARBASE        	= $FF13     ; TED Character data base address (ob bit 2-7)
+	TED_VIDEOBASE			= $FF14		; TED color and screen memory base address (on bit 3-7)
 	TED_BGCOLOR				= $FF15		; TED background color and luminance register
 	TED_BORDERCOLOR			= $FF19		; TED border color and luminance register
+	TED_RASTERHI			= $FF1C		; TED raster line counter high bit (on bit 0)
+	TED_RASTER				= $FF1D		; TED raster line counter low byte
+	TED_KEYBOARD			= $FF08		; TED keyboard and joystick latch
+	KEYBOARD_COLUMN			= $FD30		; Keyboard column select latch
 	TED_ROMREADENABLE		= $FF3E		; TED ROM read enable
 	TED_RAMREADENABLE		= $FF3F		; TED RAM read enable
 	GETIN                   = $FFE4     ; GETIN kernal call for reading keyboard buffer
+	JIFFYCLOCK				= $A5		; Low byte of kernal jiffy clock, increased every frame
 
     ; Zero page addresses
 	ZP1						= $D8
 	ZP2						= $D9
 	ZP3						= $DA
 	ZP4						= $DB
+	ZP5						= $DC
+	ZP6						= $DD
+	ZP7						= $DE
+	ZP8						= $DF
 
     ; Segment to store code in
     .segment    "PRGGEN"
@@ -55,7 +65,50 @@ charsetlowercase:
 pages:
 	.res 1								; $1080: Pages to copy
 
+	; Jump over the screen map variables to the start of the code
+	jmp start
+
+mapwidth:
+	.res 2								; $1084: screen map width
+mapmaxx:
+	.res 2								; $1086: highest horizontal view offset (width-40)
+mapmaxy:
+	.res 2								; $1088: highest vertical view offset (height-25)
+mapplane:
+	.res 2								; $108A: offset from attribute to character data (width*height+24)
+charsetdest:
+	.res 1								; $108C: high byte of 1K aligned charset copy destination
+mapaddress:
+	.word screendata					; $108D: address of screen map data
+packedsize:
+	.res 2								; $108F: size of RLE packed payload, 0 if stored unpacked
+packedtop:
+	.res 2								; $1091: address to move packed payload to for unpacking in place
+screenbase:
+	.res 1								; $1093: high byte of 2K aligned 40x25 screen to show in place, 0 to copy
+framecount:
+	.res 1								; $1094: number of slideshow frames, below 2 for a single screen
+framedelay:
+	.res 1								; $1095: frame time in jiffies, 0 to wait for a key per frame
+framesaddress:
+	.res 2								; $1096: address of first RLE packed slideshow frame
+buffer1:
+	.res 1								; $1098: high byte of first 2K aligned slideshow screen buffer
+buffer2:
+	.res 1								; $1099: high byte of second 2K aligned slideshow screen buffer
+
+start:
+	lda TED_VIDEOBASE					; Save TED video base to restore on exit
+	sta videobase
+
+	; Unpack screen map and charset if the payload is packed
+	lda packedsize						; Check if packed size is set
+	ora packedsize+1
+	beq setcolors						; Branch if payload is stored unpacked
+	jsr decrunch						; Unpack payload in place
+
 	; Set background color
+setcolors:
     lda bgcolor							; Load color value
     sta TED_BGCOLOR						; Store in TED rgeister for background color and luminance
 
@@ -67,20 +120,23 @@ pages:
     lda charsetaddress+1	            ; Load high byte of charset address variable
     cmp #$00                            ; Compare to zero to see if address is set
 	beq upperorlower			        ; Branch if it equals to zero=no redefine needed
+	cmp charsetdest						; Compare to destination to see if charset is in place already
+	beq setcharbase						; Branch if so, no copy needed
 	lda charsetaddress					; Load low byte of charset address
 	sta ZP1								; Store in ZP pointer
 	lda charsetaddress+1				; Load high byte of charset address
 	sta ZP2								; Store in ZP pointer
 	lda #$00							; Load 0 for detination address low byte
 	sta ZP3								; Store in ZP pointer
-	lda #$30							; Load $30 for detination address high byte
+	lda charsetdest						; Load detination address high byte
 	sta ZP4								; Store in ZP pointer
 	lda #$04							; Load 8 for 8 pages to copy
 	sta pages							; Store in counter variable
 	jsr memcopy							; Copy memory
+setcharbase:
 	lda TED_CHARBASE					; Load present value of TED Chararcter base address register
 	and #$03							; Perform logical AND with $03 to clear address bits
-	ora #$30							; Perform logical OR with $30 as high byte to set address bits
+	ora charsetdest						; Perform logical OR with destination high byte to set address bits
 	sta TED_CHARBASE					; Store in TED register again
 	lda TED_RAMSELECT					; Load present value of TED RAM select register
 	and #$FB							; Perform logical AND with $FB to clear bit 2 to look at RAM for charset
@@ -110,9 +166,29 @@ uppercase:
 
 	; Copy screen to visual screen memory area
 copyscreen:
-	lda #<screendata					; Obtain low byte of screen data address
+	lda framecount						; Check if there is a slideshow
+	cmp #$02
+	bcc checkviewer						; Branch if not
+	jmp slideshow						; Jump to slideshow player otherwise
+checkviewer:
+	lda mapmaxx							; Check if the screen map is larger than 40x25
+	ora mapmaxx+1
+	ora mapmaxy
+	ora mapmaxy+1
+	beq singlescreen					; Branch if not, a single screen is copied as a whole
+	jmp viewer							; Jump to scrolling viewer otherwise
+singlescreen:
+	lda screenbase						; Check if screen can be shown in place
+	beq copysingle						; Branch if not, copy it then
+	lda TED_VIDEOBASE					; Load present value of TED video base register
+	and #$07							; Perform logical AND with $07 to clear address bits
+	ora screenbase						; Perform logical OR with screen high byte to set address bits
+	sta TED_VIDEOBASE					; Store in TED register again
+	jmp waitkey							; Jump to wait for key to skip copying
+copysingle:
+	lda mapaddress						; Obtain low byte of screen data address
 	sta ZP1								; Store in ZP pointer
-	lda #>screendata					; Obtain high byte of screen data address
+	lda mapaddress+1					; Obtain high byte of screen data address
 	sta ZP2								; Store in ZP pointer
 	lda #$00							; Load 0 for color memory low byte
 	sta ZP3								; Store in ZP pointer
@@ -128,6 +204,9 @@ waitkey:
     beq waitkey
 
 	; Reset charsets
+resetcharsets:
+	lda videobase						; Restore TED video base
+	sta TED_VIDEOBASE
 	lda TED_CHARBASE					; Load present value of TED Chararcter base address register
 	and #$03							; Perform logical AND with $03 to clear address bits
 	ora #$D0							; Perform logical OR with $D0 to set ROM high byte for uppercase ROM charset
@@ -164,6 +243,616 @@ memcopy_inner:
 	bne memcopy							; Loop until zero is reached
 	rts
 
+	; Unpack RLE packed payload in place
+	; The packed data is first moved up from the end of the runtime to packedtop, so unpacking forward from there to the map address
+	; never overwrites packed bytes that are not read yet
+decrunch:
+	lda #<screendata					; Source of move is packed data directly after the runtime
+	sta ZP1
+	lda #>screendata
+	sta ZP2
+	lda packedtop						; Destination of move is packed top
+	sta ZP3
+	lda packedtop+1
+	sta ZP4
+	ldx packedsize+1					; Start at last page of source and destination, as move is upwards
+	clc
+	txa
+	adc ZP2
+	sta ZP2
+	clc
+	txa
+	adc ZP4
+	sta ZP4
+	inx									; Count partial last page as a page
+	ldy packedsize						; Move bytes of the last page first
+	beq decrunch_nextpage				; Branch if no partial page
+	dey
+	beq decrunch_lastbyte
+decrunch_move:
+	lda (ZP1),y							; Move byte, downwards from the end
+	sta (ZP3),y
+	dey
+	bne decrunch_move
+decrunch_lastbyte:
+	lda (ZP1),y							; Move byte at index zero
+	sta (ZP3),y
+decrunch_nextpage:
+	dey									; Next page starts at index $FF
+	dec ZP2								; Previous page of source and destination
+	dec ZP4
+	dex									; Decrease page counter
+	bne decrunch_move					; Loop until all pages are moved
+
+	lda packedtop						; Unpack from packed top
+	sta ZP1
+	lda packedtop+1
+	sta ZP2
+	lda mapaddress						; to map address
+	sta ZP3
+	lda mapaddress+1
+	sta ZP4
+
+	; Unpack RLE stream from source in ZP1/ZP2 pointer to destination in ZP3/ZP4 pointer,
+	; same format as TED_RLE_Unpack_core in ted_core_assembly.s
+	; Leaves the source pointer directly after the end marker, so the next stream can follow
+unpack:
+	ldy #$00							; Set index to control byte
+	lda (ZP1),y							; Load control byte
+	cmp #$ff							; Check for end marker
+	beq unpack_end						; Branch to end if end marker found
+	cmp #$80							; Check for run or literal
+	bcs unpack_run						; Branch if run
+
+	; Literal: copy (value+1) bytes, forward as the destination may be just below the source
+	tax									; Set X counter at count minus 1
+	inc ZP1								; Increase source pointer past control byte
+	bne unpack_litloop					; Skip high byte if no page crossed
+	inc ZP2								; Increase high byte of source pointer
+unpack_litloop:
+	lda (ZP1),y							; Load literal byte
+	sta (ZP3),y							; Store at destination
+	iny									; Increase index
+	dex									; Decrease counter
+	bpl unpack_litloop					; Loop until counter past zero
+	tya									; Add count to source
+	clc
+	adc ZP1
+	sta ZP1
+	bcc unpack_adddest
+	inc ZP2
+	jmp unpack_adddest					; Add count to destination
+
+	; Run: repeat next byte (value-$7E) times
+unpack_run:
+	sbc #$7f							; Subtract with carry set for count minus 1
+	tax									; Set X counter at count minus 1
+	ldy #$01							; Set index to value byte
+	lda (ZP1),y							; Load value to repeat
+	ldy #$00							; Set index to start of destination
+unpack_runloop:
+	sta (ZP3),y							; Store value at destination
+	iny									; Increase index
+	dex									; Decrease counter
+	bpl unpack_runloop					; Loop until counter past zero
+	clc									; Skip control and value byte
+	lda ZP1
+	adc #$02
+	sta ZP1
+	bcc unpack_adddest
+	inc ZP2
+
+unpack_adddest:
+	tya									; Add count to destination
+	clc
+	adc ZP3
+	sta ZP3
+	bcc unpack
+	inc ZP4
+	jmp unpack							; Next control byte
+
+unpack_end:
+	inc ZP1								; Skip end marker
+	bne unpack_done
+	inc ZP2
+unpack_done:
+	rts
+
+	; Slideshow of 40x25 frames, each frame is unpacked in the hidden buffer while the other buffer is shown
+	; With a frame time frames loop until a key is pressed, without each key shows the next frame until the last
+	; Unpacking a frame takes about 27,500 cycles for long runs to 37,700 for literals, more than the about 23,000
+	; of a PAL frame with the display on, so a frame is shown at best every second frame: 25 frames per second
+slideshow:
+	lda framesaddress					; Start at first frame
+	sta frameptr
+	lda framesaddress+1
+	sta frameptr+1
+	lda #$00
+	sta framenumber
+	lda buffer1							; First frame goes to buffer 1
+	sta backbuffer
+	lda buffer2
+	sta frontbuffer
+	jsr unpackframe						; Unpack first frame
+	jmp slide_flip						; and show it directly
+
+slide_loop:
+	jsr unpackframe						; Unpack next frame in hidden buffer
+slide_wait:
+	jsr GETIN							; Read key from keyboard buffer
+	tax									; Keep key
+	lda framedelay						; Check for timed or manual slideshow
+	beq slide_manual					; Branch if manual
+	txa									; Any key ends timed slideshow
+	beq slide_timer
+	jmp resetcharsets
+slide_timer:
+	sec									; Wait until frame time has passed since last flip
+	lda JIFFYCLOCK
+	sbc flipjiffy
+	cmp framedelay
+	bcc slide_wait
+	bcs slide_flip
+slide_manual:
+	txa									; Wait for key
+	beq slide_wait
+	lda framenumber						; Check if hidden buffer holds the first frame again, so the last frame is shown
+	cmp #$01
+	bne slide_flip
+	jmp resetcharsets					; Key on last frame ends slideshow
+
+slide_flip:
+	lda TED_RASTER						; Wait for raster below the text area to flip
+	cmp #$CC
+	bne slide_flip
+	lda TED_VIDEOBASE					; Load present value of TED video base register
+	and #$07							; Perform logical AND with $07 to clear address bits
+	ora backbuffer						; Perform logical OR with hidden buffer high byte to show it
+	sta TED_VIDEOBASE					; Store in TED register again
+	lda JIFFYCLOCK						; Remember time of flip
+	sta flipjiffy
+	ldx backbuffer						; Swap buffers
+	lda frontbuffer
+	sta backbuffer
+	stx frontbuffer
+	jmp slide_loop
+
+	; Unpack the frame at the frame pointer to the hidden buffer and advance to the next frame, wrapping after the last
+unpackframe:
+	lda frameptr						; Source is frame pointer
+	sta ZP1
+	lda frameptr+1
+	sta ZP2
+	lda #$00							; Destination is hidden buffer
+	sta ZP3
+	lda backbuffer
+	sta ZP4
+	jsr unpack							; Unpack frame
+	lda ZP1								; Next frame follows the end marker
+	sta frameptr
+	lda ZP2
+	sta frameptr+1
+	inc framenumber						; Increase frame number
+	lda framenumber
+	cmp framecount						; Check if past last frame
+	bne unpackframe_end
+	lda #$00							; Wrap to first frame
+	sta framenumber
+	lda framesaddress
+	sta frameptr
+	lda framesaddress+1
+	sta frameptr+1
+unpackframe_end:
+	rts
+
+	; Scrolling viewer for screen maps larger than 40x25
+	; Cursor keys or a joystick in either port scroll, any other key or fire exits
+viewer:
+	lda #$00							; Start at upper left corner of the map
+	sta xoffset
+	sta xoffset+1
+	sta yoffset
+	sta yoffset+1
+	sta viewoffset
+	sta viewoffset+1
+	sta lastrow
+	sta lastrow+1
+	ldx #24								; Offset of the last view row is 24 map widths
+viewer_lastrow:
+	clc
+	lda lastrow
+	adc mapwidth
+	sta lastrow
+	lda lastrow+1
+	adc mapwidth+1
+	sta lastrow+1
+	dex
+	bne viewer_lastrow
+	jsr drawview						; Draw first view
+
+viewloop:
+	jsr GETIN							; Read key from keyboard buffer
+	beq readjoystick					; Check joystick if no key is pressed
+	ldx #$FE							; Translate cursor keys to joystick direction bits
+	cmp #$91							; Cursor up
+	beq direction
+	ldx #$FD
+	cmp #$11							; Cursor down
+	beq direction
+	ldx #$FB
+	cmp #$9D							; Cursor left
+	beq direction
+	ldx #$F7
+	cmp #$1D							; Cursor right
+	beq direction
+	jmp resetcharsets					; Other key ends viewer
+
+readjoystick:
+	sei									; Keep keyboard scan interrupt away from the latch
+	lda #$FF							; Deselect all keyboard columns
+	sta KEYBOARD_COLUMN
+	lda #$F9							; Select both joystick ports
+	sta TED_KEYBOARD
+	lda TED_KEYBOARD					; Read joystick bits, active low
+	cli
+	tax									; Keep direction bits
+	and #$C0							; Check fire buttons
+	cmp #$C0
+	beq direction						; Branch if no fire button is pressed
+	jmp resetcharsets					; Fire ends viewer
+
+direction:
+	txa									; Get direction bits, shift out to carry in order up, down, left, right
+	lsr a
+	bcc moveup
+	lsr a
+	bcc movedown
+	lsr a
+	bcc moveleft
+	lsr a
+	bcc moveright
+	jmp viewloop						; No direction
+
+moveup:
+	lda yoffset							; Check if already at top
+	ora yoffset+1
+	beq nomove
+	lda yoffset							; Decrease vertical offset
+	bne moveup_dec
+	dec yoffset+1
+moveup_dec:
+	dec yoffset
+	sec									; Move view offset one row up
+	lda viewoffset
+	sbc mapwidth
+	sta viewoffset
+	lda viewoffset+1
+	sbc mapwidth+1
+	sta viewoffset+1
+	jmp redraw							; A shift down would run upwards into the beam, so copy the view from the map
+
+movedown:
+	lda yoffset							; Check if already at bottom
+	cmp mapmaxy
+	bne movedown_inc
+	lda yoffset+1
+	cmp mapmaxy+1
+	beq nomove
+movedown_inc:
+	inc yoffset							; Increase vertical offset
+	bne movedown_add
+	inc yoffset+1
+movedown_add:
+	clc									; Move view offset one row down
+	lda viewoffset
+	adc mapwidth
+	sta viewoffset
+	lda viewoffset+1
+	adc mapwidth+1
+	sta viewoffset+1
+	lda #$28							; Source is color and screen memory one row down
+	sta ZP1
+	sta ZP5
+	lda #$08
+	sta ZP2
+	lda #$0C
+	sta ZP6
+	lda #40								; Next source row is 40 further
+	sta stride
+	lda #$00
+	sta stride+1
+	jsr screendest						; Destination is the top row
+	lda #24								; Shift up all rows but the last
+	sta rows
+	jsr waitraster
+	jsr copyrows
+	lda lastrow							; Copy the exposed last row from the map, destination is left at the last row
+	ldy lastrow+1
+	jsr mapsource
+	lda #$01
+	sta rows
+	jsr copyrows
+	jmp viewloop
+
+nomove:
+	jmp viewloop						; At edge of the map, nothing to redraw
+
+moveleft:
+	lda xoffset							; Check if already at left edge
+	ora xoffset+1
+	beq nomove
+	lda xoffset							; Decrease horizontal offset
+	bne moveleft_dec
+	dec xoffset+1
+moveleft_dec:
+	dec xoffset
+	lda viewoffset						; Move view offset one column left
+	bne moveleft_view
+	dec viewoffset+1
+moveleft_view:
+	dec viewoffset
+	lda #$00							; Shift right and expose the first column
+	sta leftshift
+	jmp scrollcolumn
+
+moveright:
+	lda xoffset							; Check if already at right edge
+	cmp mapmaxx
+	bne moveright_inc
+	lda xoffset+1
+	cmp mapmaxx+1
+	beq nomove
+moveright_inc:
+	inc xoffset							; Increase horizontal offset
+	bne moveright_view
+	inc xoffset+1
+moveright_view:
+	inc viewoffset						; Move view offset one column right
+	bne moveright_shift
+	inc viewoffset+1
+moveright_shift:
+	lda #$01							; Shift left and expose the last column
+	sta leftshift
+
+scrollcolumn:
+	lda #$00							; Map source is the first column of the view
+	tay
+	jsr mapsource
+	lda #$00							; Destination is the top row
+	jsr screendest
+	jsr waitraster
+	jsr shiftcolumns
+	jmp viewloop
+
+redraw:
+	jsr drawview						; Refill the screen from the map at the new offset
+	jmp viewloop
+
+	; Copy the 40x25 part of the screen map at the view offset to color and screen memory
+drawview:
+	lda #$00							; Source is the map at the view offset
+	tay
+	jsr mapsource
+	lda #$00							; Destination is the top row
+	jsr screendest
+	lda #25								; Copy all rows
+	sta rows
+	jsr waitraster
+
+	; Copy rows of 40 cells of attributes and characters to color and screen memory, row by row from the top
+	; The addresses are set in the absolute indexed copy loop for every row, as that is faster than indirect indexed
+	; Input: ZP1/ZP2 source attributes, ZP5/ZP6 source characters, stride as distance of source rows,
+	;        ZP3/ZP4 destination color memory, ZP7/ZP8 destination screen memory, rows as number of rows
+	; Leaves the pointers at the row below the last copied row
+copyrows:
+	lda ZP1								; Set source and destination addresses in the copy loop
+	sta copyrows_attr+1
+	lda ZP2
+	sta copyrows_attr+2
+	lda ZP5
+	sta copyrows_char+1
+	lda ZP6
+	sta copyrows_char+2
+	lda ZP3
+	sta copyrows_color+1
+	sta copyrows_screen+1
+	lda ZP4
+	sta copyrows_color+2
+	lda ZP8
+	sta copyrows_screen+2
+	ldx #39								; Column counter
+copyrows_loop:
+copyrows_attr:
+	lda $FFFF,x							; Copy attribute
+copyrows_color:
+	sta $FFFF,x
+copyrows_char:
+	lda $FFFF,x							; Copy character
+copyrows_screen:
+	sta $FFFF,x
+	dex
+	bpl copyrows_loop
+	jsr nextrow							; Advance pointers to next row
+	dec rows							; Decrease row counter
+	bne copyrows						; Loop until all rows are copied
+	rts
+
+	; Shift color and screen memory one column and copy the exposed column from the map, row by row from the top
+	; Input: ZP1/ZP2 and ZP5/ZP6 map attributes and characters of the first column of the view in the top row,
+	;        ZP3/ZP4 and ZP7/ZP8 color and screen memory of the top row, leftshift 1 to shift left, 0 to shift right
+shiftcolumns:
+	lda #25								; Row counter
+	sta rows
+shiftcolumns_row:
+	ldx ZP3								; Low byte of the second column, rows start at a multiple of 40 so no carry
+	inx
+	lda leftshift						; Check direction
+	beq shiftright
+	stx shiftleft_attr+1				; Shift left: each cell gets the cell right of it, from the first column up
+	stx shiftleft_char+1
+	lda ZP3
+	sta shiftleft_color+1
+	sta shiftleft_screen+1
+	lda ZP4
+	sta shiftleft_attr+2
+	sta shiftleft_color+2
+	lda ZP8
+	sta shiftleft_char+2
+	sta shiftleft_screen+2
+	ldx #$00
+shiftleft_loop:
+shiftleft_attr:
+	lda $FFFF,x							; Copy attribute
+shiftleft_color:
+	sta $FFFF,x
+shiftleft_char:
+	lda $FFFF,x							; Copy character
+shiftleft_screen:
+	sta $FFFF,x
+	inx
+	cpx #39
+	bne shiftleft_loop
+	ldy #39								; Last column is exposed
+	bne shiftcolumns_fill
+shiftright:
+	stx shiftright_color+1				; Shift right: each cell gets the cell left of it, from the last column down
+	stx shiftright_screen+1
+	lda ZP3
+	sta shiftright_attr+1
+	sta shiftright_char+1
+	lda ZP4
+	sta shiftright_attr+2
+	sta shiftright_color+2
+	lda ZP8
+	sta shiftright_char+2
+	sta shiftright_screen+2
+	ldx #38
+shiftright_loop:
+shiftright_attr:
+	lda $FFFF,x							; Copy attribute
+shiftright_color:
+	sta $FFFF,x
+shiftright_char:
+	lda $FFFF,x							; Copy character
+shiftright_screen:
+	sta $FFFF,x
+	dex
+	bpl shiftright_loop
+	ldy #$00							; First column is exposed
+shiftcolumns_fill:
+	lda (ZP1),y							; Copy exposed attribute from the map
+	sta (ZP3),y
+	lda (ZP5),y							; Copy exposed character from the map
+	sta (ZP7),y
+	jsr nextrow							; Advance pointers to next row
+	dec rows							; Decrease row counter
+	bne shiftcolumns_row				; Loop until all rows are shifted
+	rts
+
+	; Advance source pointers by the stride and destination pointers by 40 to the next row
+nextrow:
+	clc									; Next source row is a stride further
+	lda ZP1
+	adc stride
+	sta ZP1
+	lda ZP2
+	adc stride+1
+	sta ZP2
+	clc
+	lda ZP5
+	adc stride
+	sta ZP5
+	lda ZP6
+	adc stride+1
+	sta ZP6
+	clc									; Next destination row is 40 further, same low byte for both
+	lda ZP3
+	adc #40
+	sta ZP3
+	sta ZP7
+	bcc nextrow_end
+	inc ZP4
+	inc ZP8
+nextrow_end:
+	rts
+
+	; Set source pointers to the map at the view offset plus the offset in A (low) and Y (high), stride to the map width
+mapsource:
+	clc									; Attribute source pointer is map address plus offset
+	adc mapaddress
+	sta ZP1
+	tya
+	adc mapaddress+1
+	sta ZP2
+	clc									; Plus view offset
+	lda ZP1
+	adc viewoffset
+	sta ZP1
+	lda ZP2
+	adc viewoffset+1
+	sta ZP2
+	clc									; Character source pointer is a plane further
+	lda ZP1
+	adc mapplane
+	sta ZP5
+	lda ZP2
+	adc mapplane+1
+	sta ZP6
+	lda mapwidth						; Next source row is a map width further
+	sta stride
+	lda mapwidth+1
+	sta stride+1
+	rts
+
+	; Set destination pointers to color memory at $0800 and screen memory at $0C00 plus the low byte in A
+screendest:
+	sta ZP3
+	sta ZP7
+	lda #$08
+	sta ZP4
+	lda #$0C
+	sta ZP8
+	rts
+
+	; Wait for the raster to leave the first text row: copying from the top then stays behind the beam
+	; for the rest of this frame and, as the copy takes less than a frame, ahead of it in the next one
+waitraster:
+	lda TED_RASTER						; Wait for raster line 12, the first line below text row 0
+	cmp #$0C
+	bne waitraster
+	lda TED_RASTERHI					; Skip line 268 in the lower border, which has the same low byte
+	lsr a
+	bcs waitraster
+	rts
+
+	; Runtime variables
+videobase:
+	.res 1								; TED video base at start
+xoffset:
+	.res 2								; Horizontal view offset
+yoffset:
+	.res 2								; Vertical view offset
+viewoffset:
+	.res 2								; Offset of upper left view position in the map: yoffset*width+xoffset
+frameptr:
+	.res 2								; Address of next slideshow frame to unpack
+framenumber:
+	.res 1								; Number of next slideshow frame to unpack
+backbuffer:
+	.res 1								; High byte of hidden slideshow buffer
+frontbuffer:
+	.res 1								; High byte of shown slideshow buffer
+flipjiffy:
+	.res 1								; Jiffy clock at last flip
+lastrow:
+	.res 2								; Offset of the last view row in the map: 24*width
+stride:
+	.res 2								; Distance of source rows to copy
+rows:
+	.res 1								; Number of rows left to copy
+leftshift:
+	.res 1								; Column shift direction, 1 for left and 0 for right
+
 screendata:
 	.byte $00,$00,$00,$00
 
@@ -18,6 +18,13 @@ unsigned char bootdevice;
 unsigned char targetdevice;
 char filename[21];
 char filedest[21];
+char slidename[MAXSLIDES][16];
+unsigned char slides = 1;
+unsigned char framedelay;
+unsigned char callable;
+unsigned int loadaddress = BASEADDRESS;
+unsigned int callscreen;
+unsigned int callcharset;
 char buffer[81];
 char version[22];
 unsigned int screenwidth;
@@ -31,10 +38,33 @@ unsigned char x,newtargetdevice,error,key;
 unsigned char valid = 0;
 unsigned int length;
 unsigned int address;
-unsigned char projbuffer[22];
+unsigned int mapsize;
+unsigned long mapend;
+unsigned int payload;
+unsigned int runtimeend;
+unsigned int charsetstart;
+unsigned char aligned;
+unsigned int packedsize;
+unsigned int packedgap;
+unsigned int packdest;
+unsigned char packblock[RLE_STREAMBLOCK+RLE_MAXCOUNT+1];
+unsigned char projbuffer[PROJ_HEADERSIZE];
+unsigned char* projmeta;
+unsigned char container;
 char* ptrend;
+unsigned char charsetoriginal[CHAR_SIZE];
+unsigned char charsetcompact[CHAR_SIZE];
+unsigned char glyphmap[CHAR_SIZE/8];
+unsigned char glyphs;
 
 // Generic routines
+void unblank(void)
+{
+    // Show the display again after generating with blanked screen, also on exit after an error
+
+    POKE(TED_CONTROL1,PEEK(TED_CONTROL1) | 0x10);
+}
+
 unsigned char dosCommand(const unsigned char lfn, const unsigned char drive, const unsigned char sec_addr, const char *cmd)
 {
     // Send DOS command
@@ -209,6 +239,533 @@ unsigned int load_save_data(char* filename, unsigned char deviceid, unsigned int
     return error;
 }
 
+unsigned int read_rle_data(unsigned int address, unsigned int size)
+{
+    // Function to read RLE packed data from the open file 2 and unpack it while reading,
+    // same format as TED_RLE_Read in ted_core.c
+    // Input: destination address and unpacked size
+    // Output: address after last written byte, 0 on error
+
+    unsigned char block[256];
+    unsigned char* dst = (unsigned char*)address;
+    unsigned char* end = (unsigned char*)(address+size);
+    unsigned char literal = 0;
+    unsigned char run = 0;
+    int read, pos;
+
+    while((read = cbm_read(2,block,256)) > 0)
+    {
+        for(pos=0;pos<read;pos++)
+        {
+            if(literal)
+            {
+                if(dst == end) { return 0; }
+                *dst++ = block[pos];
+                literal--;
+            }
+            else if(run)
+            {
+                if(dst + run > end) { return 0; }
+                memset(dst,block[pos],run);
+                dst += run;
+                run = 0;
+            }
+            else if(block[pos] == 0xff)
+            {
+                return (dst == end)? (unsigned int)dst : 0;
+            }
+            else if(block[pos] & 0x80)
+            {
+                run = block[pos] - 0x7e;
+            }
+            else
+            {
+                literal = block[pos] + 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+unsigned int load_screen_data(char* filename, unsigned char deviceid, unsigned int address, unsigned int size)
+{
+    // Function to load screen data from a compressed or raw screen file.
+    // Input: filename, device id, destination address and unpacked size
+    // Output: address after last written byte, 0 on error
+
+    unsigned char header[SCRN_HEADERSIZE];
+    unsigned int end;
+
+    if(cbm_open(2,deviceid,2,filename)) { return 0; }
+
+    if(cbm_read(2,header,SCRN_HEADERSIZE) != SCRN_HEADERSIZE || header[0] != SCRN_MAGIC0 || header[1] != SCRN_MAGIC1 || header[2] != SCRN_MAGIC2 || header[3] != SCRN_VERSION)
+    {
+        // No compressed screen file, so load as raw screen file
+        cbm_close(2);
+        return load_save_data(filename,deviceid,address,size,0);
+    }
+
+    end = read_rle_data(address,size);
+    cbm_close(2);
+    return end;
+}
+
+unsigned char read_project_header(char* filename, unsigned char deviceid)
+{
+    // Function to read the header of a project container file to projbuffer
+    // Input: filename and device id
+    // Output: 1 if file is a project container, file 2 is then left open after the header
+
+    if(cbm_open(2,deviceid,2,filename)) { return 0; }
+
+    if(cbm_read(2,projbuffer,PROJ_HEADERSIZE) == PROJ_HEADERSIZE && projbuffer[0] == PROJ_MAGIC0 && projbuffer[1] == PROJ_MAGIC1 && projbuffer[2] == PROJ_MAGIC2 && projbuffer[3] == PROJ_VERSION)
+    {
+        return 1;
+    }
+
+    cbm_close(2);
+    return 0;
+}
+
+void load_project_meta(char* name)
+{
+    // Function to read project variables from a container file, or from a .proj file of older versions
+    // Input: project filename without .proj, exits on error
+
+    sprintf(buffer,"%s.proj",name);
+    container = read_project_header(buffer,targetdevice);
+    if(container)
+    {
+        cbm_close(2);
+        projmeta = projbuffer+4;
+    }
+    else
+    {
+        length = load_save_data(buffer,targetdevice,(unsigned int)projbuffer,PROJ_METASIZE,0);
+        if(length<=(unsigned int)projbuffer)
+        { 
+            cprintf("Read error on reading project file.\n\r");
+            exit(1);
+        }
+        projmeta = projbuffer;
+    }
+    charsetchanged          = projmeta[ 0];
+    charsetlowercase        = projmeta[ 1];
+    screenwidth             = projmeta[ 4]*256+projmeta[ 5];
+    screenheight            = projmeta[ 6]*256+projmeta[ 7];
+    screenbackground        = projmeta[10];
+    screenborder            = projmeta[20];
+}
+
+void load_project_screen(char* name, unsigned int screenaddress, unsigned int charsetaddress)
+{
+    // Function to load the screen data and, if changed, the charset of the project of which the variables are loaded
+    // Input: project filename without .proj, destination addresses of screen and charset, exits on error
+
+    cprintf("Loading screen data at %4X.\n\r",screenaddress);
+    if(container)
+    {
+        // Container holds the charset before the screen, so read charset first
+        sprintf(buffer,"%s.proj",name);
+        length = 0;
+        if(read_project_header(buffer,targetdevice))
+        {
+            if(!charsetchanged || cbm_read(2,(void*)charsetaddress,CHAR_SIZE) == CHAR_SIZE)
+            {
+                length = read_rle_data(screenaddress,screenwidth*screenheight*2+24);
+            }
+            cbm_close(2);
+        }
+    }
+    else
+    {
+        sprintf(buffer,"%s.scrn",name);
+        length = load_screen_data(buffer,targetdevice,screenaddress,screenwidth*screenheight*2+24);
+    }
+    if(length<=screenaddress)
+    {
+        cprintf("Load error on loading screen data.");
+        exit(1);
+    }
+
+    // Load standard charset if defined
+    if(charsetchanged)
+    {
+        cprintf("Loading charset at %4X.\n\r",charsetaddress);
+        sprintf(buffer,"%s.chrs",name);
+        length = container? charsetaddress+CHAR_SIZE : load_save_data(buffer,targetdevice,charsetaddress,CHAR_SIZE,0);
+        if(length<=charsetaddress)
+        {
+            cprintf("Load error on loading standard charset data.");
+            exit(1);
+        }
+    }
+}
+
+unsigned char pack_flush(unsigned int fill, unsigned char mode)
+{
+    // Function to write the filled part of the pack block to the open file 2 or to memory at packdest
+    // Input: number of bytes in block and mode: PACK_MEASURE, PACK_FILE or PACK_MEMORY
+    // Output: error code, 0 if no error
+
+    if(mode == PACK_FILE && cbm_write(2,packblock,fill) != (int)fill) { return 1; }
+    if(mode == PACK_MEMORY)
+    {
+        memcpy((void*)packdest,packblock,fill);
+        packdest += fill;
+    }
+    return 0;
+}
+
+unsigned char pack_payload(unsigned int source, unsigned int length, unsigned char mode)
+{
+    // Function to RLE pack the payload, same format as TED_RLE_Pack in ted_core.c, and optionally write it to the open file 2
+    // or to memory at packdest.
+    // Also finds the largest distance the unpacked data runs ahead of the packed data: the runtime moves
+    // the packed data up by that distance, so it can be unpacked in place without overwriting unread bytes.
+    // Input: source address, unpacked length and mode: PACK_MEASURE, PACK_FILE or PACK_MEMORY
+    // Output: error code, 0 if no error. Packed size in packedsize, distance in packedgap
+
+    unsigned char* src = (unsigned char*)source;
+    unsigned char* end = src + length;
+    unsigned char* literal;
+    unsigned int fill = 0;
+    unsigned int flushed = 0;
+    unsigned char count;
+
+    packedgap = 0;
+
+    while(src < end)
+    {
+        // Count number of equal bytes
+        count = 1;
+        while(src+count < end && count < RLE_MAXCOUNT && src[count] == *src) { count++; }
+
+        if(count > 2)
+        {
+            // Store run
+            packblock[fill++] = count + 0x7e;
+            packblock[fill++] = *src;
+            src += count;
+        }
+        else
+        {
+            // Store literal until next run of three equal bytes
+            literal = src;
+            count = 0;
+            do
+            {
+                src++;
+                count++;
+            } while(src < end && count < RLE_MAXCOUNT && (src+2 >= end || src[0] != src[1] || src[0] != src[2]));
+            packblock[fill++] = count - 1;
+            memcpy(packblock+fill,literal,count);
+            fill += count;
+        }
+
+        // Track distance of unpacked data ahead of packed data after this control byte
+        if((unsigned int)src - source > flushed + fill + packedgap) { packedgap = (unsigned int)src - source - flushed - fill; }
+
+        // Write full block
+        if(fill >= RLE_STREAMBLOCK)
+        {
+            if(pack_flush(fill,mode)) { return 1; }
+            flushed += fill;
+            fill = 0;
+        }
+    }
+
+    packblock[fill++] = RLE_END;
+    if(length > flushed + fill + packedgap) { packedgap = length - flushed - fill; }
+    packedsize = flushed + fill;
+
+    return pack_flush(fill,mode);
+}
+
+void charset_start(unsigned int charset)
+{
+    // Function to start a compacted charset for the charset at the given address
+
+    memcpy(charsetoriginal,(void*)charset,CHAR_SIZE);
+    memset(glyphmap,0xff,sizeof(glyphmap));
+    glyphs = 0;
+}
+
+void charset_remap(unsigned int plane, unsigned int length)
+{
+    // Function to add the glyphs used in a character plane to the compacted charset and remap the plane to it.
+    // Glyphs are added in order of first use, a glyph with the same bitmap as one added before is mapped to that one.
+    // Bit 7 selects reverse and is kept.
+    // Input: address and length of character plane
+
+    unsigned char* chars = (unsigned char*)plane;
+    unsigned char* end = chars + length;
+    unsigned char* bitmap;
+    unsigned char glyph, x;
+
+    for(;chars<end;chars++)
+    {
+        glyph = *chars & 0x7f;
+        if(glyphmap[glyph] == 0xff)
+        {
+            bitmap = charsetoriginal + glyph*8;
+            for(x=0;x<glyphs && memcmp(charsetcompact+x*8,bitmap,8);x++) {}
+            if(x == glyphs)
+            {
+                memcpy(charsetcompact+x*8,bitmap,8);
+                glyphs++;
+            }
+            glyphmap[glyph] = x;
+        }
+        *chars = (*chars & 0x80) | glyphmap[glyph];
+    }
+}
+
+void generate_screen()
+{
+    // Function to place, load and pack a single screen map of the project with its charset
+
+    // Place a 40x25 screen on a 2K boundary and the charset on a 1K boundary, so the runtime can show them
+    // by setting the TED base addresses without copying. If that does not fit below the generator,
+    // place them directly after the runtime and let the runtime copy them. A 40x25 screen takes 2K.
+    runtimeend = PEEK(MAPADDRESS)+256*PEEK(MAPADDRESS+1);
+    mapend = (unsigned long)screenwidth*screenheight*2+24;
+    mapsize = (mapend < SCREEN_SIZE)? SCREEN_SIZE : (unsigned int)mapend;
+    address = (screenwidth==40 && screenheight==25)? (runtimeend+0x7FF) & 0xF800 : runtimeend;
+    charsetstart = charsetchanged? (address+mapsize+0x3FF) & 0xFC00 : address+mapsize;
+    mapend = charsetstart + (unsigned long)(charsetchanged? CHAR_SIZE : 0);
+    aligned = 1;
+    if(mapend > GENERATORBASE)
+    {
+        address = runtimeend;
+        charsetstart = address+mapsize;
+        mapend = charsetstart + (unsigned long)(charsetchanged? CHAR_SIZE : 0);
+        aligned = 0;
+    }
+    if(mapend > GENERATORBASE)
+    {
+        cprintf("Screen too large, program would end at %5lX.\n\r",mapend);
+        exit(1);
+    }
+    memset((void*)runtimeend,0,(unsigned int)mapend-runtimeend);
+    POKEW(MAPADDRESS,address);                               // Set screen map address
+    if(aligned && screenwidth==40 && screenheight==25)
+    {
+        POKE(SCREENBASE_ADDR,address>>8);                    // Set TED video base to the screen in place
+    }
+
+    // Load screen
+    POKE(BGCOLORADDRESS,screenbackground);                   // Set background color
+    POKE(BORDERCOLORADDR,screenborder);                      // Set border color
+    POKE(CHARSET_LOWER,charsetlowercase);                    // Set lowercase flag
+    POKEW(MAPWIDTH_ADDR,screenwidth);                        // Set map width
+    POKEW(MAPMAXX_ADDR,screenwidth-40);                      // Set highest view offsets, zero for a single screen
+    POKEW(MAPMAXY_ADDR,screenheight-25);
+    POKEW(MAPPLANE_ADDR,screenwidth*screenheight+24);        // Set offset of character data
+    load_project_screen(filename,address,charsetstart);
+    payload = address;
+    address = charsetstart;
+
+    // Set standard charset if defined
+    if(charsetchanged)
+    {
+        // Keep only the glyphs the screen uses, once each
+        charset_start(charsetstart);
+        charset_remap(payload+screenwidth*screenheight+24,screenwidth*screenheight);
+        memcpy((void*)charsetstart,charsetcompact,glyphs*8);
+        cprintf("Charset compacted to %u glyphs.\n\r",glyphs);
+
+        POKE(CHARSET_ADDRESS,address&0xff);                   // Set low byte charset address
+        POKE(CHARSET_ADDRESS+1,(address>>8)&0xff);            // Set high byte charset address
+        // Show charset in place, or copy it at run time to $3000 or the first 1K boundary after the program if that is further
+        if(aligned)
+        {
+            POKE(CHARSET_DEST,address>>8);
+        }
+        else
+        {
+            POKE(CHARSET_DEST,(address+CHAR_SIZE <= CHARSET_COPY)? CHARSET_COPY>>8 : ((address+CHAR_SIZE+0x3FF)>>8) & 0xFC);
+        }
+        address+=glyphs*8;
+    }
+
+    // Pack screen map and charset, this pass only measures the packed size and the distance to unpack in place
+    cprintf("Packing %u bytes of screen data.\n\r",address-payload);
+    pack_payload(payload,address-payload,PACK_MEASURE);
+    if(packedsize < address-runtimeend && (unsigned long)payload+packedgap+packedsize <= GENERATORBASE)
+    {
+        cprintf("Packed to %u bytes.\n\r",packedsize);
+        POKEW(PACKEDSIZE_ADDR,packedsize);                    // Set packed size
+        POKEW(PACKEDTOP_ADDR,payload+packedgap);              // Set address to move packed data to at run time
+    }
+    else
+    {
+        cprintf("Data does not pack, stored unpacked.\n\r");
+        packedsize = 0;
+    }
+}
+
+void generate_slideshow()
+{
+    // Function to generate a slideshow of 40x25 screens. The charset and colors of the first project are used.
+    // The charset is the packed payload, followed by all screens as separate RLE streams that the runtime
+    // unpacks alternately to two 2K aligned buffers, so the next screen is shown by setting the TED video base.
+    // The charset is compacted to the glyphs used by all screens, so it is packed last: the screens are packed
+    // after room for the packed charset and moved down to directly after it at the end.
+
+    unsigned int staging = GENERATORBASE-SCREEN_SIZE-CHAR_SIZE;
+    unsigned int buffer1;
+    unsigned int charsetsize = 0;
+    unsigned int charsetgap = 0;
+    unsigned int frames;
+    unsigned char withcharset = charsetchanged;
+    unsigned char slide;
+
+    runtimeend = PEEK(MAPADDRESS)+256*PEEK(MAPADDRESS+1);
+    frames = withcharset? runtimeend+CHARSET_RESERVE : runtimeend;
+    packdest = frames;
+    POKE(BGCOLORADDRESS,screenbackground);                   // Set background color
+    POKE(BORDERCOLORADDR,screenborder);                      // Set border color
+    POKE(CHARSET_LOWER,charsetlowercase);                    // Set lowercase flag
+
+    // Load and pack all screens, unpacked screen and charset are staged below the generator
+    for(slide=0;slide<slides;slide++)
+    {
+        if(slide) { load_project_meta(slidename[slide]); }
+        if(screenwidth!=40 || screenheight!=25)
+        {
+            cprintf("Slideshow screens must be 40x25.\n\r");
+            exit(1);
+        }
+        if(packdest > staging-SCREEN_SIZE-CHAR_SIZE-0x40)
+        {
+            cprintf("Too many screens for memory.\n\r");
+            exit(1);
+        }
+        memset((void*)staging,0,SCREEN_SIZE);
+        load_project_screen(slidename[slide],staging,staging+SCREEN_SIZE);
+        if(withcharset)
+        {
+            if(!slide) { charset_start(staging+SCREEN_SIZE); }
+            charset_remap(staging+40*25+24,40*25);
+        }
+        cprintf("Packing screen %u at %4X.\n\r",slide+1,packdest);
+        pack_payload(staging,SCREEN_SIZE,PACK_MEMORY);
+    }
+
+    // Pack the compacted charset directly after the runtime and move the screens down to after it
+    if(withcharset)
+    {
+        cprintf("Packing charset of %u glyphs.\n\r",glyphs);
+        address = packdest;
+        packdest = runtimeend;
+        pack_payload((unsigned int)charsetcompact,glyphs*8,PACK_MEMORY);
+        charsetsize = packedsize;
+        charsetgap = packedgap;
+        memmove((void*)packdest,(void*)frames,address-frames);
+        packdest += address-frames;
+        frames = runtimeend+charsetsize;
+    }
+    POKEW(FRAMES_ADDR,frames);                               // Set address of first screen
+
+    // Place the two screen buffers on the first 2K boundary after the program, and the charset after them
+    address = packdest;
+    buffer1 = (address+0x7FF) & 0xF800;
+    charsetstart = buffer1+2*SCREEN_SIZE;
+    mapend = (unsigned long)charsetstart + (withcharset? charsetgap+charsetsize : 0);
+    if(mapend > GENERATORBASE)
+    {
+        cprintf("Slideshow too large, would end at %5lX.\n\r",mapend);
+        exit(1);
+    }
+    POKE(FRAMECOUNT_ADDR,slides);                            // Set number of screens
+    POKE(FRAMEDELAY_ADDR,framedelay);                        // Set frame time
+    POKE(BUFFER1_ADDR,buffer1>>8);                           // Set screen buffers
+    POKE(BUFFER2_ADDR,(buffer1+SCREEN_SIZE)>>8);
+    if(withcharset)
+    {
+        POKEW(CHARSET_ADDRESS,charsetstart);                 // Charset is unpacked in place at run time
+        POKE(CHARSET_DEST,charsetstart>>8);
+        POKEW(MAPADDRESS,charsetstart);
+        POKEW(PACKEDSIZE_ADDR,charsetsize);
+        POKEW(PACKEDTOP_ADDR,charsetstart+charsetgap);
+    }
+
+    // All data is packed in memory already, so save it as is
+    packedsize = 0;
+}
+
+void generate_callable()
+{
+    // Function to generate a routine that shows a single 40x25 screen when called and returns, see prgcall.s.
+    // The routine runs at any address, only the address of its data block is set here for the load address.
+    // The block holds the screen and charset addresses and the colors, followed by the RLE packed screen
+    // and, if redefined, the RLE packed compacted charset.
+
+    unsigned int staging = GENERATORBASE-SCREEN_SIZE-CHAR_SIZE;
+    unsigned long end;
+
+    if(screenwidth!=40 || screenheight!=25)
+    {
+        cprintf("Callable routine needs a 40x25 screen.\n\r");
+        exit(1);
+    }
+    runtimeend = BASEADDRESS+CALL_SIZE;
+    POKE(CALL_BLOCKLO,(loadaddress+CALL_BLOCK-BASEADDRESS)&0xff);  // Set data block address for load address
+    POKE(CALL_BLOCKHI,(loadaddress+CALL_BLOCK-BASEADDRESS)>>8);
+    POKE(CALL_SCREEN,callscreen>>8);                         // Set screen address
+    POKE(CALL_CHARSET,charsetchanged? callcharset>>8 : 0);   // Set charset address, 0 for ROM charset
+    POKE(CALL_LOWER,charsetlowercase);                       // Set lowercase flag
+    POKE(CALL_BGCOLOR,screenbackground);                     // Set background color
+    POKE(CALL_BORDER,screenborder);                          // Set border color
+
+    // Load screen and charset below the generator and pack them after the routine
+    load_project_screen(filename,staging,staging+SCREEN_SIZE);
+    if(charsetchanged)
+    {
+        charset_start(staging+SCREEN_SIZE);
+        charset_remap(staging+40*25+24,40*25);
+    }
+    packdest = runtimeend;
+    cprintf("Packing screen.\n\r");
+    pack_payload(staging,40*25*2+24,PACK_MEMORY);
+    if(charsetchanged)
+    {
+        cprintf("Packing charset of %u glyphs.\n\r",glyphs);
+        pack_payload((unsigned int)charsetcompact,glyphs*8,PACK_MEMORY);
+    }
+    address = packdest;
+
+    // The routine must not overwrite itself when it shows the screen
+    end = (unsigned long)loadaddress+address-BASEADDRESS;
+    if(end > 0xFD00 || (loadaddress < (unsigned long)callscreen+SCREEN_SIZE && end > callscreen) ||
+       (charsetchanged && loadaddress < (unsigned long)callcharset+glyphs*8 && end > callcharset))
+    {
+        cprintf("Routine from %4X to %5lX overlaps screen, charset or I/O.\n\r",loadaddress,end);
+        exit(1);
+    }
+
+    // All data is packed in memory already, so save it as is
+    packedsize = 0;
+}
+
+unsigned int ask_address(char* prompt, unsigned int value, unsigned int align)
+{
+    // Function to ask for a hexadecimal address with the given alignment, address 0 is not accepted
+    // as it is in the zero page and a charset address of 0 would select the ROM charset
+    // Input: prompt, default address and alignment as power of two
+
+    cprintf("\n\r%s (hex):",prompt);
+    do
+    {
+        sprintf(buffer,"%04X",value);
+        textInput(0,wherey()+1,buffer,4);
+        r = (unsigned int)strtol(buffer,&ptrend,16);
+    } while (!r || (r & (align-1)));
+    return r;
+}
+
 void main()
 {
     // Obtain device number the application was started from
@@ -253,8 +810,22 @@ void main()
     cputsxy(0,5,"Choose filename of project to load: ");
     textInput(0,6,filename,15);
 
-    cputsxy(0,7,"Choose filename of generated program:");
-    textInput(0,8,filedest,20);
+    // More projects make a slideshow
+    strcpy(slidename[0],filename);
+    cputsxy(0,7,"Add slideshow screen, empty to end:");
+    while(slides < MAXSLIDES)
+    {
+        cclearxy(0,8,40);
+        slidename[slides][0] = 0;
+        if(textInput(0,8,slidename[slides],15) < 1) { break; }
+        slides++;
+    }
+    cclearxy(0,8,40);
+    gotoxy(0,8);
+    cprintf("%u screen(s)",slides);
+
+    cputsxy(0,9,"Choose filename of generated program:");
+    textInput(0,10,filedest,20);
 
     // Check if outtput file already exists
     sprintf(buffer,"r0:%s=%s",filedest,filedest);
@@ -262,7 +833,7 @@ void main()
 
     if (error == 63)
     {
-        cputsxy(0,9,"Output file exists. Are you sure? Y/N ");
+        cputsxy(0,11,"Output file exists. Are you sure? Y/N ");
         do
         {
             key = cgetc();
@@ -280,26 +851,57 @@ void main()
         }
     }
 
-    cprintf("\n\n\rLoading project meta data.\n\r");
+    // Frame time of slideshow
+    if(slides > 1)
+    {
+        cprintf("\n\rFrame time in 1/50 s, 0 waits for key:");
+        do
+        {
+            strcpy(buffer,"0");
+            textInput(0,wherey()+1,buffer,3);
+            r = (unsigned int)strtol(buffer,&ptrend,10);
+        } while (r > 255);
+        framedelay = (unsigned char)r;
+    }
 
-    // Load project variables
-    sprintf(buffer,"%s.proj",filename);
-    length = load_save_data(buffer,targetdevice,(unsigned int)projbuffer,22,0);
-    if(length<=(unsigned int)projbuffer)
-    { 
-        cprintf("Read error on reading project file.\n\r");
-        exit(1);
+    // Routine to call from own programs instead of a program to run, for a single screen
+    if(slides == 1)
+    {
+        cprintf("\n\rCallable routine instead of program? Y/N ");
+        do
+        {
+            key = cgetc();
+        } while (key!='y' && key!='n');
+        cputc(key);
+        if(key=='y')
+        {
+            callable = 1;
+            loadaddress = ask_address("Load address of routine",0x2000,1);
+            callscreen = ask_address("Screen address, 2K aligned",0x0800,SCREEN_SIZE);
+            callcharset = ask_address("Charset address if redefined, 1K aligned",CHARSET_COPY,CHAR_SIZE);
+        }
     }
-    charsetchanged          = projbuffer[ 0];
-    charsetlowercase        = projbuffer[ 1];
-    screenwidth             = projbuffer[ 4]*256+projbuffer[ 5];
-    screenheight            = projbuffer[ 6]*256+projbuffer [7];
-    screenbackground        = projbuffer[10];
-    screenborder            = projbuffer[20];
 
-    if(screenwidth!=40 || screenheight!=25)
+    // Blank the display while generating, as the CPU then runs at double clock for the whole frame
+    cprintf("\n\rBlank screen while generating? Y/N ");
+    do
     {
-        cprintf("Only screen dimension of 40x25 supported.\n\r");
+        key = cgetc();
+    } while (key!='y' && key!='n');
+    cputc(key);
+    if(key=='y')
+    {
+        atexit(unblank);
+        POKE(TED_CONTROL1,PEEK(TED_CONTROL1) & 0xef);
+    }
+
+    cprintf("\n\n\rLoading project meta data.\n\r");
+
+    load_project_meta(filename);
+
+    if(screenwidth<40 || screenheight<25)
+    {
+        cprintf("Screen smaller than 40x25 not supported.\n\r");
         exit(1);
     }
 
@@ -309,55 +911,54 @@ void main()
 
     cprintf("Loading assembly code at %4X.\n\r",address);
 
-    // Load loader program
-    length = load_save_data("tedse2prg.ass",bootdevice,address,ASS_SIZE,0);
+    // Load loader program, or the callable routine
+    length = callable? load_save_data("tedse2prg.call",bootdevice,address,CALL_SIZE,0) : load_save_data("tedse2prg.ass",bootdevice,address,ASS_SIZE,0);
     if(length<=BASEADDRESS)
     {
         cprintf("Load error on loading assembly code.");
         exit(1);
     }
 
-    // Poke version string
-    cprintf("Poking version string.\n\r");
-    for(x=0;x<22;x++)
+    // Poke version string in the BASIC header
+    if(!callable)
     {
-        POKE(BASEADDRESS+VERSIONADDRESS+x,version[x]);
+        cprintf("Poking version string.\n\r");
+        for(x=0;x<22;x++)
+        {
+            POKE(BASEADDRESS+VERSIONADDRESS+x,version[x]);
+        }
     }
 
-    // Load screen
-    address=SCREENSTART;
-    cprintf("Loading screen data at %4X.\n\r",address);
-    POKE(BGCOLORADDRESS,screenbackground);                   // Set background color
-    POKE(BORDERCOLORADDR,screenborder);                      // Set border color
-    POKE(CHARSET_LOWER,charsetlowercase);                    // Set lowercase flag
-    sprintf(buffer,"%s.scrn",filename);
-    length = load_save_data(buffer,targetdevice,address,SCREEN_SIZE,0);
-    if(length<=address)
+    if(callable)
     {
-        cprintf("Load error on loading screen data.");
-        exit(1);
+        generate_callable();
     }
-    address+=SCREEN_SIZE;
-
-    // Load standard charset if defined
-    if(charsetchanged)
+    else if(slides > 1)
     {
-        cprintf("Loading charset at %4X.\n\r",address);
-        POKE(CHARSET_ADDRESS,address&0xff);                   // Set low byte charset address
-        POKE(CHARSET_ADDRESS+1,(address>>8)&0xff);            // Set high byte charset address
-        sprintf(buffer,"%s.chrs",filename);
-        length = load_save_data(buffer,targetdevice,address,CHAR_SIZE,0);
-        if(length<=address)
-        {
-            cprintf("Load error on loading standard charset data.");
-            exit(1);
-        }
-        address+=CHAR_SIZE;
+        generate_slideshow();
+    }
+    else
+    {
+        generate_screen();
     }
 
-    // Save complete generated program
-    cprintf("Saving from %4X to %4X.\n\r",BASEADDRESS,address);
-    if(load_save_data(filedest,targetdevice,BASEADDRESS,address,1))
+    // Save complete generated program: load address, runtime and packed or unpacked payload
+    cprintf("Saving from %4X to %4X.\n\r",loadaddress,(packedsize? runtimeend+packedsize : address)-BASEADDRESS+loadaddress);
+    sprintf(buffer,"%s,p,w",filedest);
+    if(cbm_open(2,targetdevice,2,buffer))
+    {
+        cprintf("Save error on writing generated program.");
+        exit(1);
+    }
+    projbuffer[0] = loadaddress & 0xff;
+    projbuffer[1] = (loadaddress>>8) & 0xff;
+    error = cbm_write(2,projbuffer,2) != 2 || cbm_write(2,(void*)BASEADDRESS,runtimeend-BASEADDRESS) != (int)(runtimeend-BASEADDRESS);
+    if(!error)
+    {
+        error = packedsize? pack_payload(payload,address-payload,PACK_FILE) : cbm_write(2,(void*)runtimeend,address-runtimeend) != (int)(address-runtimeend);
+    }
+    cbm_close(2);
+    if(error)
     {
         cprintf("Save error on writing generated program.");
         exit(1);
@@ -0,0 +1,469 @@
+// ====================================================================================
+// screenmap.c
+// Screen map routines of TED Screen Editor: addressing, layout, resizing,
+// area operations and flood fill
+//
+// These only access memory, not the screen, keyboard or disk, so they also
+// compile with a host compiler against the memory shim in screenmap.h,
+// as tools/tedsemapbench.c does to check and time them on large canvases.
+//
+// =====================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include "defines.h"
+#ifdef __CC65__
+#include <plus4.h>
+#include <time.h>
+#include "ted_core.h"
+#endif
+#include "screenmap.h"
+
+// Screen map state
+unsigned int screenwidth;
+unsigned int screenheight;
+unsigned int screentotal;
+unsigned int screenstride;
+unsigned int screenplane;
+unsigned char screenalign = 0;
+unsigned char dirtyrows[DIRTYROWS_SIZE];
+unsigned char dirtyrows_any;
+
+// Resident code
+#pragma code-name ("CODE")
+#pragma rodata-name ("RODATA")
+
+void dirtyrows_mark(unsigned int row, unsigned int count)
+{
+    // Mark screen map rows as modified since the last autosave
+    // Input: first row, number of rows
+
+    while(count--)
+    {
+        if(row < FILLMAXROWS) { dirtyrows[row>>3] |= 1<<(row&7); }
+        row++;
+    }
+    dirtyrows_any = 1;
+}
+
+unsigned int screenmap_screenaddr(unsigned int row, unsigned int col)
+{
+    // Function to calculate screenmap address for the character space
+    // Input: row, col in the present screenmap layout
+
+    return SCREENMAPBASE+(row*screenstride)+col+screenplane;
+}
+
+unsigned int screenmap_attraddr(unsigned int row, unsigned int col)
+{
+    // Function to calculate screenmap address for the attribute space
+    // Input: row, col in the present screenmap layout
+
+    return SCREENMAPBASE+(row*screenstride)+col;
+}
+
+unsigned int screenmap_packedscreenaddr(unsigned int row, unsigned int col, unsigned int width, unsigned int height)
+{
+    // Function to calculate packed layout screenmap address for the character space
+    // Input: row, col, width and height for screenmap
+
+    return SCREENMAPBASE+(row*width)+col+(width*height)+24;
+}
+
+unsigned int screenmap_packedattraddr(unsigned int row, unsigned int col, unsigned int width)
+{
+    // Function to calculate packed layout screenmap address for the attribute space
+    // Input: row, col and width for screenmap
+
+    return SCREENMAPBASE+(row*width)+col;
+}
+
+void screenmapplot(unsigned int row, unsigned int col, unsigned char screencode, unsigned char attribute)
+{
+    // Function to plot a screencodes at bank 1 memory screen map
+	// Input: row and column, screencode to plot, attribute code
+
+    POKE(screenmap_screenaddr(row,col),screencode);
+    POKE(screenmap_attraddr(row,col),attribute);
+    dirtyrows_mark(row,1);
+}
+
+void placesignature()
+{
+    // Place signature in screenmap with program version in the 24 bytes before the character data
+
+    char versiontext[25] = "";
+    unsigned char x;
+    unsigned int address = SCREENMAPBASE + screenplane - 24;
+
+    sprintf(versiontext," %s ",version);
+
+    for(x=0;x<strlen(versiontext);x++)
+    {
+        POKE(address+x,versiontext[x]);
+    }
+}
+
+void screenmapfill(unsigned char screencode, unsigned char attribute)
+{
+    // Function to fill screen with the screencode and attribute code provided as input
+
+    unsigned int address = SCREENMAPBASE;
+
+    memset(MEMORY(address),attribute,screenplane);
+    placesignature();
+    address += screenplane;
+    memset(MEMORY(address),screencode,screenstride*screenheight);
+    dirtyrows_mark(0,screenheight);
+}
+
+unsigned int screenmap_alignedstride(unsigned int width)
+{
+    // Function to calculate row stride for aligned layout: a power of two up to a page,
+    // or a whole number of pages for wider screens, so no row crosses a page boundary
+    // Input: width of screenmap
+
+    unsigned int stride = 64;
+
+    if(width > 256) { return (width + 0xff) & 0xff00; }
+    while(stride < width) { stride <<= 1; }
+    return stride;
+}
+
+unsigned int screenmap_alignedsize(unsigned int width, unsigned int height)
+{
+    // Function to calculate memory needed for aligned layout
+    // Input: width and height of screenmap
+
+    unsigned int stride = screenmap_alignedstride(width);
+
+    return ((stride*height + 24 + 0xff) & 0xff00) + stride*height;
+}
+
+unsigned char screenmap_fits(unsigned int width, unsigned int height)
+{
+    // Function to check if a screenmap size fits in memory in the selected layout
+    // Input: width and height of screenmap
+
+    unsigned int maxsize = MEMORYLIMIT - SCREENMAPBASE;
+
+    if(width<40 || height<25 || (unsigned long)width*height*2 + 24 > maxsize) { return 0; }
+    if(screenalign && screenmap_alignedsize(width,height) > maxsize) { return 0; }
+    return 1;
+}
+
+unsigned char screenmap_setlayout(unsigned char aligned)
+{
+    // Function to convert the screenmap in place between packed and aligned layout
+    // Packed layout is the file format: rows of width bytes, character data 24 bytes after attribute data.
+    // Aligned layout pads rows to screenmap_alignedstride() and starts character data at a page boundary,
+    // which costs memory but speeds up the viewport copy and scroll routines.
+    // Input: requested layout, packed (0) or aligned (1)
+    // Output: applied layout, aligned falls back to packed if it does not fit in memory
+
+    unsigned int newstride = screenwidth;
+    unsigned int newplane = screentotal + 24;
+    unsigned int y;
+
+    if(aligned)
+    {
+        if(screenmap_alignedsize(screenwidth,screenheight) > MEMORYLIMIT - SCREENMAPBASE)
+        {
+            aligned = 0;
+        }
+        else
+        {
+            newstride = screenmap_alignedstride(screenwidth);
+            newplane = (newstride*screenheight + 24 + 0xff) & 0xff00;
+        }
+    }
+
+    if(newstride == screenstride && newplane == screenplane) { return aligned; }
+
+    if(aligned)
+    {
+        // Expand: move last rows first, character data before attribute data
+        for(y=screenheight;y>0;y--)
+        {
+            memmove(MEMORY(SCREENMAPBASE+newplane+(y-1)*newstride),MEMORY(screenmap_screenaddr(y-1,0)),screenwidth);
+        }
+        for(y=screenheight;y>0;y--)
+        {
+            memmove(MEMORY(SCREENMAPBASE+(y-1)*newstride),MEMORY(screenmap_attraddr(y-1,0)),screenwidth);
+        }
+    }
+    else
+    {
+        // Shrink: move first rows first, attribute data before character data
+        for(y=0;y<screenheight;y++)
+        {
+            memmove(MEMORY(SCREENMAPBASE+y*newstride),MEMORY(screenmap_attraddr(y,0)),screenwidth);
+        }
+        for(y=0;y<screenheight;y++)
+        {
+            memmove(MEMORY(SCREENMAPBASE+newplane+y*newstride),MEMORY(screenmap_screenaddr(y,0)),screenwidth);
+        }
+    }
+
+    screenstride = newstride;
+    screenplane = newplane;
+    placesignature();
+
+    return aligned;
+}
+
+void screenmap_copyarea(unsigned int row, unsigned int col, unsigned int destrow, unsigned int destcol, unsigned int width, unsigned int height, unsigned char cut)
+{
+    // Function to copy or move an area of the screenmap, using screen memory as row buffer
+    // Rows are copied in the order that reads every source row before it is overwritten
+    // Input: row and column of source area, row and column of destination,
+    //        width and height of area, cut: clear source area to white spaces
+
+    unsigned int ycount, y;
+
+    for(ycount=0;ycount<height;ycount++)
+    {
+        y=(destrow>=row)? height-ycount-1 : ycount;
+        memcpy(MEMORY(SCREENMEMORY),MEMORY(screenmap_attraddr(row+y,col)),width);
+        if(cut) { memset(MEMORY(screenmap_attraddr(row+y,col)),COLOR_WHITE,width); }
+        memcpy(MEMORY(screenmap_attraddr(destrow+y,destcol)),MEMORY(SCREENMEMORY),width);
+        memcpy(MEMORY(SCREENMEMORY),MEMORY(screenmap_screenaddr(row+y,col)),width);
+        if(cut) { memset(MEMORY(screenmap_screenaddr(row+y,col)),CH_SPACE,width); }
+        memcpy(MEMORY(screenmap_screenaddr(destrow+y,destcol)),MEMORY(SCREENMEMORY),width);
+    }
+    dirtyrows_mark(destrow,height);
+    if(cut) { dirtyrows_mark(row,height); }
+}
+
+void screenmap_fillarea(unsigned int row, unsigned int col, unsigned int width, unsigned int height, unsigned char screencode, unsigned char attribute, unsigned char mode)
+{
+    // Function to fill an area of the screenmap with a screencode and/or attribute
+    // Input: row, column, width and height of area, screencode and attribute to fill with,
+    //        mode: fill screencode (FILL_SCREENCODE), attribute (FILL_ATTRIBUTE) or both
+
+    unsigned int y;
+
+    for(y=0;y<height;y++)
+    {
+        if(mode & FILL_SCREENCODE) { memset(MEMORY(screenmap_screenaddr(row+y,col)),screencode,width); }
+        if(mode & FILL_ATTRIBUTE) { memset(MEMORY(screenmap_attraddr(row+y,col)),attribute,width); }
+    }
+    dirtyrows_mark(row,height);
+}
+
+void screenmap_paintarea(unsigned int row, unsigned int col, unsigned int width, unsigned int height, unsigned char color)
+{
+    // Function to repaint an area of the screenmap in a color, keeping luminance and blink
+    // Input: row, column, width and height of area, color (0-15)
+
+    unsigned int x, y, address;
+
+    for(y=0;y<height;y++)
+    {
+        address = screenmap_attraddr(row+y,col);
+        for(x=0;x<width;x++)
+        {
+            POKE(address+x,(PEEK(address+x) & 0xf0)+color);
+        }
+    }
+    dirtyrows_mark(row,height);
+}
+
+// Overlay 3: resize
+#pragma code-name ("OVERLAY3")
+#pragma rodata-name ("OVERLAY3")
+
+void screenmap_resizewidth(unsigned int newwidth)
+{
+    // Function to change the screenmap width, keeping the present layout
+    // Columns added at the right are white spaces, columns removed at the right are lost
+    // Input: new width, should be checked with screenmap_fits()
+
+    unsigned int y;
+
+    screenmap_setlayout(0);
+    if(newwidth < screenwidth)
+    {
+        for(y=1;y<screenheight;y++)
+        {
+            memcpy(MEMORY(SCREENMEMORY),MEMORY(screenmap_packedattraddr(y,0,screenwidth)),newwidth);
+            memcpy(MEMORY(screenmap_packedattraddr(y,0,newwidth)),MEMORY(SCREENMEMORY),newwidth);
+        }
+        for(y=0;y<screenheight;y++)
+        {
+            memcpy(MEMORY(SCREENMEMORY),MEMORY(screenmap_packedscreenaddr(y,0,screenwidth,screenheight)),newwidth);
+            memcpy(MEMORY(screenmap_packedscreenaddr(y,0,newwidth,screenheight)),MEMORY(SCREENMEMORY),newwidth);
+        }
+    }
+    if(newwidth > screenwidth)
+    {
+        for(y=0;y<screenheight;y++)
+        {
+            memcpy(MEMORY(SCREENMEMORY),MEMORY(screenmap_packedscreenaddr(screenheight-y-1,0,screenwidth,screenheight)),screenwidth);
+            memcpy(MEMORY(screenmap_packedscreenaddr(screenheight-y-1,0,newwidth,screenheight)),MEMORY(SCREENMEMORY),screenwidth);
+            memset(MEMORY(screenmap_packedscreenaddr(screenheight-y-1,screenwidth,newwidth,screenheight)),CH_SPACE,newwidth-screenwidth);
+        }
+        for(y=0;y<screenheight;y++)
+        {
+            memcpy(MEMORY(SCREENMEMORY),MEMORY(screenmap_packedattraddr(screenheight-y-1,0,screenwidth)),screenwidth);
+            memcpy(MEMORY(screenmap_packedattraddr(screenheight-y-1,0,newwidth)),MEMORY(SCREENMEMORY),screenwidth);
+            memset(MEMORY(screenmap_packedattraddr(screenheight-y-1,screenwidth,newwidth)),COLOR_WHITE,newwidth-screenwidth);
+        }
+    }
+
+    screenwidth = newwidth;
+    screentotal = screenwidth * screenheight;
+    screenstride = screenwidth;
+    screenplane = screentotal + 24;
+    placesignature();
+    screenmap_setlayout(screenalign);
+}
+
+void screenmap_resizeheight(unsigned int newheight)
+{
+    // Function to change the screenmap height, keeping the present layout
+    // Rows added at the bottom are white spaces, rows removed at the bottom are lost
+    // Input: new height, should be checked with screenmap_fits()
+
+    unsigned int y;
+
+    screenmap_setlayout(0);
+    if(newheight < screenheight)
+    {
+        memmove(MEMORY(screenmap_packedscreenaddr(0,0,screenwidth,newheight)),MEMORY(screenmap_packedscreenaddr(0,0,screenwidth,screenheight)),newheight*screenwidth);
+    }
+    if(newheight > screenheight)
+    {
+        for(y=0;y<screenheight;y++)
+        {
+            memcpy(MEMORY(screenmap_packedscreenaddr(screenheight-y-1,0,screenwidth,newheight)),MEMORY(screenmap_packedscreenaddr(screenheight-y-1,0,screenwidth,screenheight)),screenwidth);
+        }
+        memset(MEMORY(screenmap_packedscreenaddr(screenheight,0,screenwidth,newheight)),CH_SPACE,(newheight-screenheight)*screenwidth);
+        memset(MEMORY(screenmap_packedattraddr(screenheight,0,screenwidth)),COLOR_WHITE,(newheight-screenheight)*screenwidth);
+    }
+
+    screenheight = newheight;
+    screentotal = screenwidth * screenheight;
+    screenstride = screenwidth;
+    screenplane = screentotal + 24;
+    placesignature();
+    screenmap_setlayout(screenalign);
+}
+
+// Overlay 8: fill
+#pragma code-name ("OVERLAY8")
+#pragma rodata-name ("OVERLAY8")
+
+// The row pointer table must cover the highest canvas screenmap_fits() allows, 40 columns wide
+typedef char fillmaxrows_check[((MEMORYLIMIT-SCREENMAPBASE-24)/80 <= FILLMAXROWS)? 1 : -1];
+
+// Check if cell i of a screen map row matches the area to fill
+#define FILLMATCH(chars,attrs,i) ((!(mode & FILL_SCREENCODE) || (chars)[i]==oldcode) && (!(mode & FILL_ATTRIBUTE) || (attrs)[i]==oldattr))
+
+unsigned char screenmap_fillchanges(unsigned int x, unsigned int y, unsigned char mode, unsigned char newcode, unsigned char newattr)
+{
+    // Function to check if a flood fill would change the area, a fill that does not would never end
+    // Input: x and y of start, mode, new screencode and attribute as for screenmap_floodfill()
+    // Output: 1 if the fill changes the area
+
+    return ((mode & FILL_SCREENCODE) && PEEK(screenmap_screenaddr(y,x)) != newcode) ||
+           ((mode & FILL_ATTRIBUTE) && PEEK(screenmap_attraddr(y,x)) != newattr);
+}
+
+unsigned char screenmap_floodfill(unsigned int x, unsigned int y, unsigned char mode, unsigned char newcode, unsigned char newattr)
+{
+    // Scanline flood fill of the connected area at x,y with a screencode and/or attribute
+    // Row pointers and span stack are kept in the window area, which is unused in main mode,
+    // so no multiplies per cell and no recursion on the cc65 stack are needed
+    // Input: x and y of start in the screen map,
+    //        mode: match and replace screencode (FILL_SCREENCODE), attribute (FILL_ATTRIBUTE) or both,
+    //        new screencode and attribute
+    // Output: 1 if the span stack overflowed, so part of the area may not be filled
+
+    unsigned int* rows = FILLROWPOINTERS;
+    struct FillSeed* stack = FILLSEEDS;
+    unsigned int sp = 0;
+    unsigned int xl, xr, ny, address;
+    unsigned char* chars;
+    unsigned char* attrs;
+    unsigned char oldcode, oldattr, n;
+    unsigned char overflow = 0;
+
+    if(!screenmap_fillchanges(x,y,mode,newcode,newattr)) { return 0; }
+
+    oldcode = PEEK(screenmap_screenaddr(y,x));
+    oldattr = PEEK(screenmap_attraddr(y,x));
+
+    // Precompute character data row pointers, attribute data is at screenplane below
+    address = SCREENMAPBASE + screenplane;
+    for(ny=0;ny<screenheight;ny++)
+    {
+        rows[ny] = address;
+        address += screenstride;
+    }
+
+    stack[sp].x = x;
+    stack[sp++].y = y;
+
+    while(sp)
+    {
+        sp--;
+        x = stack[sp].x;
+        y = stack[sp].y;
+        chars = MEMORY(rows[y]);
+        attrs = chars - screenplane;
+
+        // Skip seeds already filled via another span
+        if(!FILLMATCH(chars,attrs,x)) { continue; }
+
+        // Find span boundaries and fill the span
+        xl = x;
+        while(xl > 0 && FILLMATCH(chars,attrs,xl-1)) { xl--; }
+        xr = x;
+        while(xr < screenwidth-1 && FILLMATCH(chars,attrs,xr+1)) { xr++; }
+        if(mode & FILL_SCREENCODE) { memset(chars+xl,newcode,xr-xl+1); }
+        if(mode & FILL_ATTRIBUTE) { memset(attrs+xl,newattr,xr-xl+1); }
+        dirtyrows_mark(y,1);
+        TED_BlankProgress();
+
+        // Push one seed per matching run in the rows above and below the span
+        for(n=0;n<2;n++)
+        {
+            if(n==0)
+            {
+                if(y==0) { continue; }
+                ny = y-1;
+            }
+            else
+            {
+                if(y==screenheight-1) { continue; }
+                ny = y+1;
+            }
+            chars = MEMORY(rows[ny]);
+            attrs = chars - screenplane;
+            x = xl;
+            while(x <= xr)
+            {
+                if(FILLMATCH(chars,attrs,x))
+                {
+                    if(sp < FILLSTACKSIZE)
+                    {
+                        stack[sp].x = x;
+                        stack[sp++].y = ny;
+                    }
+                    else
+                    {
+                        overflow = 1;
+                    }
+                    while(x <= xr && FILLMATCH(chars,attrs,x)) { x++; }
+                }
+                else
+                {
+                    x++;
+                }
+            }
+        }
+    }
+
+    return overflow;
+}
@@ -15,6 +15,7 @@
 #include <cbm.h>
 #include <conio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <errno.h>
 #include <ctype.h>
 #include <plus4.h>
@@ -145,6 +146,50 @@ unsigned int TED_RowColToAddress(unsigned char row, unsigned char col)
 	}
 }
 
+unsigned char TED_blankmode = BLANK_OFF;
+unsigned char TED_blankdepth = 0;
+clock_t TED_blankstart;
+clock_t TED_blanktime = 0;
+
+void TED_BlankStart(void)
+{
+	// Function to blank the display before a heavy operation if enabled, so the CPU runs at double clock
+	// for the whole frame instead of single clock in the visible area. Calls can be nested.
+	// The duration of the outermost operation is kept in TED_blanktime, also with blanking off,
+	// so the gain can be measured by repeating an operation with blanking off and on.
+
+	if(!TED_blankdepth++)
+	{
+		TED_blankstart = clock();
+		if(TED_blankmode != BLANK_OFF) { POKE(TED_CONTROL1,PEEK(TED_CONTROL1) & 0xef); }
+	}
+}
+
+void TED_BlankProgress(void)
+{
+	// Function to show progress during a blanked operation by cycling the border color
+
+	if(TED_blankdepth && TED_blankmode == BLANK_PROGRESS)
+	{
+		POKE(TED_BORDERCOLOR,(PEEK(TED_BORDERCOLOR)+1) & 0x7f);
+	}
+}
+
+void TED_BlankEnd(unsigned char border)
+{
+	// Function to show the display again after the outermost blanked operation
+	// Input: border color to restore after the progress indicator
+
+	if(!TED_blankdepth) { return; }
+	if(!--TED_blankdepth)
+	{
+		TED_blanktime = clock() - TED_blankstart;
+		if(TED_blankmode == BLANK_OFF) { return; }
+		POKE(TED_BORDERCOLOR,border);
+		POKE(TED_CONTROL1,PEEK(TED_CONTROL1) | 0x10);
+	}
+}
+
 unsigned int TED_Load(char* filename, unsigned char deviceid, unsigned int destination)
 {
 	// Function to load memory from disk and save to destination address
@@ -218,13 +263,13 @@ void TED_PlotString(unsigned char row, unsigned char col, char* plotstring, unsi
 	}
 }
 
-void TED_CopyViewPortToTED(unsigned int sourcebase, unsigned int sourcewidth, unsigned int sourceheight, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight )
+void TED_CopyViewPortToTED(unsigned int sourcebase, unsigned int sourcestride, unsigned int sourceplane, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight )
 {
 	// Function to copy a viewport on the source screen map to the TED
 	// Input:
 	// - Source:	sourcebase			= source base address in memory
-	//				sourcewidth			= number of characters per line in source screen map
-	//				sourceheight		= number of lines in source screen map
+	//				sourcestride		= number of bytes per line in source screen map
+	//				sourceplane			= offset of character data to attribute data in source screen map
 	//				sourcexoffset		= horizontal offset on source screen map to start upper left corner of viewpoint
 	//				sourceyoffset		= vertical offset on source screen map to start upper left corner of viewpoint
 	// - Viewport:	xcoord				= x coordinate of viewport upper left corner
@@ -233,24 +278,31 @@ void TED_CopyViewPortToTED(unsigned int sourcebase, unsigned int sourcewidth, un
 	//				viewheight			= height of viewport in number of lines
 
 	// Colors
-	unsigned int stride = sourcewidth;
 	unsigned int TEDbase = TED_RowColToAddress(ycoord,xcoord);
 
-	sourcebase += (sourceyoffset * sourcewidth ) + sourcexoffset;
+	sourcebase += (sourceyoffset * sourcestride ) + sourcexoffset;
 
 	TED_addrh = (sourcebase>>8) & 0xff;					// Obtain high byte of source address
 	TED_addrl = sourcebase & 0xff;						// Obtain low byte of source address
 	TED_desth = (TEDbase>>8) & 0xff;					// Obtain high byte of destination address
 	TED_destl = TEDbase & 0xff;							// Obtain low byte of destination address
-	TED_strideh = (stride>>8) & 0xff;					// Obtain high byte of stride
-	TED_stridel = stride & 0xff;						// Obtain low byte of stride
+	TED_strideh = (sourcestride>>8) & 0xff;				// Obtain high byte of stride
+	TED_stridel = sourcestride & 0xff;					// Obtain low byte of stride
 	TED_tmp1 = viewheight;								// Obtain number of lines to copy
 	TED_tmp2 = viewwidth;								// Obtain length of lines to copy
 
+	// Copy both planes in one pass if character data is at a whole number of pages
+	if((sourceplane & 0xff) == 0)
+	{
+		TED_tmp3 = (sourceplane>>8) & 0xff;				// Obtain number of pages to character data
+		TED_CopyViewPortToTED_paged_core();
+		return;
+	}
+
 	TED_CopyViewPortToTED_core();
 
 	// Characters
-	sourcebase += (sourceheight * sourcewidth) + 24;
+	sourcebase += sourceplane;
 	TEDbase += 0x0400;
 
 	TED_addrh = (sourcebase>>8) & 0xff;					// Obtain high byte of source address
@@ -263,13 +315,13 @@ void TED_CopyViewPortToTED(unsigned int sourcebase, unsigned int sourcewidth, un
 	TED_CopyViewPortToTED_core();
 }
 
-void TED_ScrollCopy(unsigned int sourcebase, unsigned int sourcewidth, unsigned int sourceheight, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight, unsigned char direction)
+void TED_ScrollCopy(unsigned int sourcebase, unsigned int sourcestride, unsigned int sourceplane, unsigned int sourcexoffset, unsigned int sourceyoffset, unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight, unsigned char direction)
 {
 	// Function to scroll a viewport on the source screen map on the TED in the given direction
 	// Input:
 	// - Source:	sourcebase			= source base address in memory
-	//				sourcewidth			= number of characters per line in source screen map
-	//				sourceheight		= number of lines in source screen map
+	//				sourcestride		= number of bytes per line in source screen map
+	//				sourceplane			= offset of character data to attribute data in source screen map
 	//				sourcexoffset		= horizontal offset on source screen map to start upper left corner of viewpoint
 	//				sourceyoffset		= vertical offset on source screen map to start upper left corner of viewpoint
 	// - Viewport:	xcoord				= x coordinate of viewport upper left corner
@@ -314,7 +366,7 @@ void TED_ScrollCopy(unsigned int sourcebase, unsigned int sourcewidth, unsigned
 	default:
 		break;
 	}
-	TED_CopyViewPortToTED(sourcebase,sourcewidth,sourceheight,sourcexoffset,sourceyoffset,xcoord,ycoord,viewwidth,viewheight);
+	TED_CopyViewPortToTED(sourcebase,sourcestride,sourceplane,sourcexoffset,sourceyoffset,xcoord,ycoord,viewwidth,viewheight);
 }
 
 void TED_ScrollMove(unsigned char xcoord, unsigned char ycoord, unsigned char viewwidth, unsigned char viewheight, unsigned char direction, unsigned char clear)
@@ -419,4 +471,163 @@ void TED_ROM_Memcopy(unsigned int source, unsigned int destination, unsigned cha
 	TED_destl = destination & 0xff;								// Obtain low byte of source address
 	TED_tmp1 = pages;
 	TED_ROM_Memcopy_core();
-}
\ No newline at end of file
+}
+
+unsigned int TED_RLE_Pack(unsigned int source, unsigned int destination, unsigned int length)
+{
+	// Function to RLE pack memory, see TED_RLE_Unpack_core for the packed format
+	// Input: source and destination addresses and unpacked length in bytes.
+	//		  Destination should have room for RLE_WORSTCASE(length) bytes
+	// Output: packed length in bytes including end marker
+
+	unsigned char* src = (unsigned char*)source;
+	unsigned char* dst = (unsigned char*)destination;
+	unsigned char* end = src + length;
+	unsigned char* literal;
+	unsigned char count;
+
+	while(src < end)
+	{
+		// Count number of equal bytes
+		count = 1;
+		while(src+count < end && count < RLE_MAXCOUNT && src[count] == *src) { count++; }
+
+		if(count > 2)
+		{
+			// Store run
+			*dst++ = count + 0x7e;
+			*dst++ = *src;
+			src += count;
+		}
+		else
+		{
+			// Store literal until next run of three equal bytes
+			literal = src;
+			count = 0;
+			do
+			{
+				src++;
+				count++;
+			} while(src < end && count < RLE_MAXCOUNT && (src+2 >= end || src[0] != src[1] || src[0] != src[2]));
+			*dst++ = count - 1;
+			memcpy(dst,literal,count);
+			dst += count;
+		}
+	}
+	*dst++ = RLE_END;
+
+	return (unsigned int)dst - destination;
+}
+
+unsigned int TED_RLE_Unpack(unsigned int source, unsigned int destination)
+{
+	// Function to unpack RLE packed memory
+	// Input: source address of packed data and destination address
+	// Output: address after last written byte
+
+	TED_addrh = (source>>8) & 0xff;								// Obtain high byte of source address
+	TED_addrl = source & 0xff;									// Obtain low byte of source address
+	TED_desth = (destination>>8) & 0xff;						// Obtain high byte of destination address
+	TED_destl = destination & 0xff;								// Obtain low byte of destination address
+	TED_RLE_Unpack_core();
+	return TED_desth*256+TED_destl;
+}
+
+unsigned char TED_RLE_Write(unsigned char lfn, unsigned int source, unsigned int length)
+{
+	// Function to RLE pack memory and write it to an open file, packing blockwise in a small buffer
+	// Input: logical file number opened for writing, source address and unpacked length in bytes
+	// Output: error code, 0 if no error
+
+	unsigned char block[RLE_WORSTCASE(RLE_STREAMBLOCK)];
+	unsigned int chunk, packed;
+
+	while(length)
+	{
+		chunk = (length > RLE_STREAMBLOCK)? RLE_STREAMBLOCK : length;
+
+		// Pack block and write without end marker
+		packed = TED_RLE_Pack(source,(unsigned int)block,chunk) - 1;
+		if(cbm_write(lfn,block,packed) != (int)packed) { return 1; }
+		TED_BlankProgress();
+		source += chunk;
+		length -= chunk;
+	}
+
+	block[0] = RLE_END;
+	if(cbm_write(lfn,block,1) != 1) { return 1; }
+
+	return 0;
+}
+
+unsigned int TED_RLE_Read(unsigned char lfn, unsigned int destination, unsigned int limit)
+{
+	// Function to read RLE packed data from an open file and unpack it while reading
+	// Input: logical file number opened for reading, destination address,
+	//		  address limit that unpacked data may not pass
+	// Output: address after last written byte, 0 if the data ends early or does not fit
+
+	unsigned char block[RLE_STREAMBLOCK];
+	unsigned char* dst = (unsigned char*)destination;
+	unsigned char* end = (unsigned char*)limit;
+	unsigned char literal = 0;
+	unsigned char run = 0;
+	unsigned char copy;
+	int read, pos;
+
+	while(1)
+	{
+		read = cbm_read(lfn,block,RLE_STREAMBLOCK);
+		if(read < 1) { return 0; }
+		TED_BlankProgress();
+
+		pos = 0;
+		while(pos < read)
+		{
+			if(literal)
+			{
+				// Copy literal bytes, as many as available in this block
+				copy = (read - pos < literal)? read - pos : literal;
+				if(dst + copy > end) { return 0; }
+				memcpy(dst,block+pos,copy);
+				dst += copy;
+				pos += copy;
+				literal -= copy;
+			}
+			else if(run)
+			{
+				// Expand run with the value byte
+				if(dst + run > end) { return 0; }
+				memset(dst,block[pos++],run);
+				dst += run;
+				run = 0;
+			}
+			else if(block[pos] == RLE_END)
+			{
+				return (unsigned int)dst;
+			}
+			else if(block[pos] & 0x80)
+			{
+				run = block[pos++] - 0x7e;
+			}
+			else
+			{
+				literal = block[pos++] + 1;
+			}
+		}
+	}
+}
+
+unsigned int TED_Checksum(unsigned int source, unsigned int length)
+{
+	// Function to calculate a 16 bit additive checksum of memory
+	// Input: source address and length in bytes
+	// Output: checksum
+
+	TED_addrh = (source>>8) & 0xff;								// Obtain high byte of source address
+	TED_addrl = source & 0xff;									// Obtain low byte of source address
+	TED_strideh = (length>>8) & 0xff;							// Obtain high byte of length
+	TED_stridel = length & 0xff;								// Obtain low byte of length
+	TED_Checksum_core();
+	return TED_desth*256+TED_destl;
+}
@@ -13,12 +13,15 @@
 	.export		_TED_VChar_core
 	.export		_TED_FillArea_core
 	.export		_TED_CopyViewPortToTED_core
+	.export		_TED_CopyViewPortToTED_paged_core
 	.export		_TED_Scroll_right_core
 	.export		_TED_Scroll_left_core
 	.export		_TED_Scroll_down_core
 	.export		_TED_Scroll_up_core
 	.export		_TED_ROM_Peek_core
 	.export		_TED_ROM_Memcopy_core
+	.export		_TED_RLE_Unpack_core
+	.export		_TED_Checksum_core
 	.export		_TED_addrh
 	.export		_TED_addrl
 	.export		_TED_desth
@@ -240,6 +243,91 @@ copyloopvp:								; Start of copy loop
 	bne outerloopvp						; Continue outer loop if not yet below zero
     rts
 
+; ------------------------------------------------------------------------------------------
+_TED_CopyViewPortToTED_paged_core:
+; Function to copy attribute and character data from screen map to TED in one pass
+; Character data should be at a whole number of pages from attribute data
+; Input:	TED_addrh = high byte of attribute source address
+;			TED_addrl = low byte of attribute source address
+;			TED_desth = high byte of TED color memory destination address
+;			TED_destl = low byte of TED color memory destination address
+;			TED_strideh = high byte of bytes per line in source
+;			TED_stridel = low byte of bytes per line in source
+;			TED_tmp1 = number lines to copy
+;			TED_tmp2 = length per line to copy (maximum 128)
+;			TED_tmp3 = number of pages from attribute to character data in source
+; ------------------------------------------------------------------------------------------
+
+	; Set source address pointer in zero-page
+	lda _TED_addrl						; Obtain low byte in A
+	sta ZP1								; Store low byte in pointer
+	lda _TED_addrh						; Obtain high byte in A
+	sta ZP2								; Store high byte in pointer
+
+	; Set destination address pointer in zero-page
+	lda _TED_destl						; Obtain low byte in A
+	sta ZP3								; Store low byte in pointer
+	lda _TED_desth						; Obtain high byte in A
+	sta ZP4								; Store high byte in pointer
+
+	; Start of copy loop
+outerlooppvp:
+	ldy _TED_tmp2						; Load length of line
+	dey									; Decrease counter
+
+	; Copy attributes of line
+attrlooppvp:
+	lda (ZP1),Y							; Load source data
+	sta (ZP3),Y							; Save at destination
+	dey									; Decrease counter
+	bpl attrlooppvp						; Continue loop until index past zero
+
+	; Move pointers to character data
+	clc									; Clear carry
+	lda ZP2								; Load high byte of source address
+	adc _TED_tmp3						; Add pages to character data
+	sta ZP2								; Store high byte of source address
+	lda ZP4								; Load high byte of TED destination
+	adc #$04							; Add 4 pages to reach text memory
+	sta ZP4								; Store high byte of TED destination
+
+	; Copy characters of line
+	ldy _TED_tmp2						; Load length of line
+	dey									; Decrease counter
+charlooppvp:
+	lda (ZP1),Y							; Load source data
+	sta (ZP3),Y							; Save at destination
+	dey									; Decrease counter
+	bpl charlooppvp						; Continue loop until index past zero
+
+	; Move pointers back to attribute data
+	sec									; Set carry
+	lda ZP2								; Load high byte of source address
+	sbc _TED_tmp3						; Subtract pages to character data
+	sta ZP2								; Store high byte of source address
+	lda ZP4								; Load high byte of TED destination
+	sbc #$04							; Subtract 4 pages to reach color memory
+	sta ZP4								; Store high byte of TED destination
+
+	; Add stride to addresses for next line
+	clc									; Clear carry
+	lda	ZP1								; Load low byte of source address
+	adc _TED_stridel					; Add low byte of stride
+	sta ZP1								; Store low byte of source
+	lda ZP2								; Load high byte of source address
+	adc _TED_strideh					; Add high byte of stride
+	sta ZP2								; Store high byte of source address
+	clc									; Clear carry
+	lda ZP3								; Load low byte of TED destination
+	adc #$28							; Add 40 characters for next line
+	sta ZP3								; Store low byte of TED destination
+	bcc nextlinepvp						; Skip high byte if no page crossed
+	inc ZP4								; Increase high byte of TED destination
+nextlinepvp:
+	dec _TED_tmp1						; Decrease counter number of lines
+	bne outerlooppvp					; Continue outer loop if not yet zero
+    rts
+
 ; ------------------------------------------------------------------------------------------
 Increase_one_line:
 ; Increase source pointers by one line
@@ -589,6 +677,151 @@ tedrommemcopy_innerloop:
 	sta $FF3F							; Set system to read from RAM again
 	rts
 
+; ------------------------------------------------------------------------------------------
+_TED_RLE_Unpack_core:
+; Function to decompress RLE packed data
+; Packed format per control byte:
+;			$00-$7F = literal: copy next (value+1) bytes
+;			$80-$FE = run: repeat next byte (value-$7E) times
+;			$FF     = end of packed data
+; Input:	TED_addrh = high byte of packed source address
+;			TED_addrl = low byte of packed source address
+;			TED_desth = high byte of destination address
+;			TED_destl = low byte of destination address
+; Output:	TED_addrh/TED_addrl = address after end marker
+;			TED_desth/TED_destl = address after last written byte
+; ------------------------------------------------------------------------------------------
 
+	lda _TED_addrl						; Load low byte of source address
+	sta ZP1								; Store in zeropage pointer
+	lda _TED_addrh						; Load high byte of source address
+	sta ZP2								; Store in zeropage pointer
+	lda _TED_destl						; Load low byte of destination address
+	sta ZP3								; Store in zeropage pointer
+	lda _TED_desth						; Load high byte of destination address
+	sta ZP4								; Store in zeropage pointer
 
+rleunpack_loop:
+	ldy #$00							; Set index to control byte
+	lda (ZP1),y							; Load control byte
+	cmp #$ff							; Check for end marker
+	beq rleunpack_end					; Branch to end if end marker found
+	cmp #$80							; Check for run or literal
+	bcs rleunpack_run					; Branch if run
+
+	; Literal: copy (value+1) bytes
+	sta _TED_tmp1						; Store count minus 1
+	inc ZP1								; Increase source pointer past control byte
+	bne rleunpack_litcopy				; Skip high byte if no page crossed
+	inc ZP2								; Increase high byte of source pointer
+rleunpack_litcopy:
+	tay									; Set Y index at count minus 1
+rleunpack_litloop:
+	lda (ZP1),y							; Load literal byte
+	sta (ZP3),y							; Store at destination
+	dey									; Decrease index
+	bpl rleunpack_litloop				; Loop until index past zero
+	sec									; Set carry to add count minus 1 plus 1
+	lda ZP1								; Load low byte of source
+	adc _TED_tmp1						; Add count
+	sta ZP1								; Store low byte of source
+	lda ZP2								; Load high byte of source
+	adc #$00							; Add carry
+	sta ZP2								; Store high byte of source
+	jmp rleunpack_adddest				; Add count to destination
+
+	; Run: repeat next byte (value-$7E) times
+rleunpack_run:
+	sbc #$7f							; Subtract with carry set for count minus 1
+	sta _TED_tmp1						; Store count minus 1
+	ldy #$01							; Set index to value byte
+	lda (ZP1),y							; Load value to repeat
+	ldy _TED_tmp1						; Set Y index at count minus 1
+rleunpack_runloop:
+	sta (ZP3),y							; Store value at destination
+	dey									; Decrease index
+	bpl rleunpack_runloop				; Loop until index past zero
+	clc									; Clear carry
+	lda ZP1								; Load low byte of source
+	adc #$02							; Skip control and value byte
+	sta ZP1								; Store low byte of source
+	lda ZP2								; Load high byte of source
+	adc #$00							; Add carry
+	sta ZP2								; Store high byte of source
+
+rleunpack_adddest:
+	sec									; Set carry to add count minus 1 plus 1
+	lda ZP3								; Load low byte of destination
+	adc _TED_tmp1						; Add count
+	sta ZP3								; Store low byte of destination
+	lda ZP4								; Load high byte of destination
+	adc #$00							; Add carry
+	sta ZP4								; Store high byte of destination
+	jmp rleunpack_loop					; Next control byte
+
+rleunpack_end:
+	inc ZP1								; Increase source pointer past end marker
+	bne rleunpack_store					; Skip high byte if no page crossed
+	inc ZP2								; Increase high byte of source pointer
+rleunpack_store:
+	lda ZP1								; Load low byte of source
+	sta _TED_addrl						; Store as output
+	lda ZP2								; Load high byte of source
+	sta _TED_addrh						; Store as output
+	lda ZP3								; Load low byte of destination
+	sta _TED_destl						; Store as output
+	lda ZP4								; Load high byte of destination
+	sta _TED_desth						; Store as output
+	rts
 
+; ------------------------------------------------------------------------------------------
+_TED_Checksum_core:
+; Function to calculate 16 bit additive checksum of memory
+; Input:	TED_addrh = high byte of start address
+;			TED_addrl = low byte of start address
+;			TED_strideh = high byte of length
+;			TED_stridel = low byte of length
+; Output:	TED_desth/TED_destl = checksum
+; ------------------------------------------------------------------------------------------
+
+	lda _TED_addrl						; Load low byte of start address
+	sta ZP1								; Store in zeropage pointer
+	lda _TED_addrh						; Load high byte of start address
+	sta ZP2								; Store in zeropage pointer
+	lda #$00							; Clear checksum
+	sta _TED_destl						; Store low byte of checksum
+	sta _TED_desth						; Store high byte of checksum
+	tay									; Start index at zero
+	ldx _TED_strideh					; Load number of whole pages
+	beq checksum_rest					; Skip to remaining bytes if none
+
+checksum_page:
+	lda (ZP1),y							; Load byte
+	clc									; Clear carry
+	adc _TED_destl						; Add to low byte of checksum
+	sta _TED_destl						; Store low byte of checksum
+	bcc checksum_pagenext				; Skip high byte if no carry
+	inc _TED_desth						; Increase high byte of checksum
+checksum_pagenext:
+	iny									; Next byte
+	bne checksum_page					; Continue until page done
+	inc ZP2								; Next page
+	dex									; Decrease page counter
+	bne checksum_page					; Continue until all pages done
+
+checksum_rest:
+	ldx _TED_stridel					; Load number of remaining bytes
+	beq checksum_end					; Done if none
+checksum_byte:
+	lda (ZP1),y							; Load byte
+	clc									; Clear carry
+	adc _TED_destl						; Add to low byte of checksum
+	sta _TED_destl						; Store low byte of checksum
+	bcc checksum_bytenext				; Skip high byte if no carry
+	inc _TED_desth						; Increase high byte of checksum
+checksum_bytenext:
+	iny									; Next byte
+	dex									; Decrease counter
+	bne checksum_byte					; Continue until all bytes done
+checksum_end:
+	rts
@@ -0,0 +1,785 @@
+/*
+TED Screen Editor
+TEDSE2PRG batch converter, runs on the build host
+Written in 2022 by Xander Mol
+
+https://github.com/xahmol/TEDScreenEdit
+https://www.idreamtin8bits.com/
+
+Converts TEDSE projects to executable programs in the same layout as TEDSE2PRG
+on the Plus/4 does for a single project, using the TEDSE2PRG.ASS runtime.
+
+Usage: tedse2prgbatch [-a <runtime PRG>] [-o <output directory>] [-x raw|rle|tiles] [-f asm|bin]
+                      [-c <load address> [-s <screen address>] [-k <charset address>]] <project or directory> [...]
+
+A project is given by its filename with or without .proj. For a directory all
+projects in it are converted, a name.proj.prg is skipped if name.proj is there too. Project, screen and charset files are read as
+named on disk (name.proj) or as extracted with a .prg extension (name.proj.prg).
+Every project is written as <name>.prg in the output directory, by default the
+directory of the project.
+
+With -x the screen map is exported as data instead, as the export data option
+of the editor does: <name>.chr and <name>.atr for characters and attributes,
+<name>.set for a redefined charset, with .s added for assembly source (-f asm,
+the default). Decoders for the data are in tools/tedsedecode.s.
+
+With -c a callable routine is written instead of a program, as TEDSE2PRG does
+when asked for a callable routine, using the TEDSE2PRG.CALL runtime. Addresses
+are hexadecimal, screen and charset default to 0800 and 3000.
+*/
+
+//Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include "defines.h"
+#include "prggenerator.h"
+#include "tedserle.h"
+
+#define PATH_MAX_LENGTH     1024        // Maximum length of a path
+
+unsigned char mem[0x10000];             // Plus/4 memory image the program is built in
+unsigned char runtime[0x10000];
+unsigned int runtimesize;
+unsigned char filebuffer[0x10000];
+unsigned char packed[0x10200];
+unsigned char exportset[CHAR_SIZE];
+unsigned char charsetoriginal[CHAR_SIZE];
+unsigned char charsetcompact[CHAR_SIZE];
+unsigned char glyphmap[CHAR_SIZE/8];
+unsigned int glyphs;
+unsigned int packedsize;
+unsigned int packedgap;
+char path[PATH_MAX_LENGTH];
+char versionstring[32];
+int exportencoding = -1;                // Encoding for data export, -1 to generate programs
+int exportasm = 1;
+unsigned int exportcount;
+FILE* exportfile;
+int callable;
+unsigned int loadaddress = BASEADDRESS;
+unsigned int callscreen = 0x0800;
+unsigned int callcharset = CHARSET_COPY;
+
+void pokew(unsigned int address, unsigned int value)
+{
+    // Store 16 bit value low byte first, as POKEW on the Plus/4
+
+    mem[address] = value & 0xff;
+    mem[address+1] = (value>>8) & 0xff;
+}
+
+long read_file(const char* dir, const char* name, const char* extension)
+{
+    // Read a file as named on disk, or with .prg added
+    // Input: directory, name and extension of file
+    // Output: number of bytes read in filebuffer, -1 if not found
+
+    FILE* file;
+    long length;
+
+    snprintf(path,PATH_MAX_LENGTH,"%s/%s.%s",dir,name,extension);
+    file = fopen(path,"rb");
+    if(!file)
+    {
+        snprintf(path,PATH_MAX_LENGTH,"%s/%s.%s.prg",dir,name,extension);
+        file = fopen(path,"rb");
+    }
+    if(!file) { return -1; }
+    length = fread(filebuffer,1,sizeof(filebuffer),file);
+    fclose(file);
+    return length;
+}
+
+int rle_unpack(unsigned char* src, long length, unsigned char* dst, unsigned int size)
+{
+    // Host version of read_rle_data() in prggenerator.c
+    // Input: packed data and its length, destination and unpacked size
+    // Output: 0 if exactly the unpacked size was found before the end marker
+
+    unsigned char* end = dst + size;
+    unsigned char* srcend = src + length;
+    unsigned int count;
+
+    while(src < srcend)
+    {
+        if(*src == RLE_END)
+        {
+            return dst != end;
+        }
+        if(*src & 0x80)
+        {
+            if(src+1 >= srcend) { return 1; }
+            count = *src - 0x7e;
+            if(dst + count > end) { return 1; }
+            memset(dst,src[1],count);
+            src += 2;
+        }
+        else
+        {
+            count = *src + 1;
+            if(src+count >= srcend || dst + count > end) { return 1; }
+            memcpy(dst,src+1,count);
+            src += count+1;
+        }
+        dst += count;
+    }
+    return 1;
+}
+
+void export_text(const char* text)
+{
+    // Write text to the export file, the host version writes ASCII as is
+
+    fputs(text,exportfile);
+}
+
+void export_byte(unsigned char value)
+{
+    // Host version of export_byte() in main.c
+
+    if(!exportasm)
+    {
+        fputc(value,exportfile);
+        return;
+    }
+    fprintf(exportfile,exportcount? ",$%02x" : "\n    .byte $%02x",value);
+    if(++exportcount == 16) { exportcount = 0; }
+}
+
+int export_tiles(unsigned char* data, unsigned int width, unsigned int height, const char* label)
+{
+    // Host version of export_tiles() in main.c, should produce identical output
+    // Output: 0 if no error
+
+    unsigned char table[4][EXPORT_MAXTILES];
+    unsigned char tile[4];
+    unsigned char* row0;
+    unsigned char* row1;
+    unsigned int count = 0;
+    unsigned int tx, ty, t, x;
+
+    for(ty=0;ty<height;ty+=2)
+    {
+        row0 = data+ty*width;
+        row1 = row0+width;
+        for(tx=0;tx<width;tx+=2)
+        {
+            tile[0] = row0[tx];
+            tile[1] = (tx+1 < width)? row0[tx+1] : 0;
+            tile[2] = (ty+1 < height)? row1[tx] : 0;
+            tile[3] = (tx+1 < width && ty+1 < height)? row1[tx+1] : 0;
+            for(t=0;t<count;t++)
+            {
+                if(table[0][t] == tile[0] && table[1][t] == tile[1] && table[2][t] == tile[2] && table[3][t] == tile[3]) { break; }
+            }
+            if(t == count)
+            {
+                if(count == EXPORT_MAXTILES) { return 1; }
+                for(x=0;x<4;x++) { table[x][t] = tile[x]; }
+                count++;
+            }
+            export_byte(t);
+        }
+    }
+
+    if(exportasm)
+    {
+        fprintf(exportfile,"\n%s_tilecount = %u\n%s_tiles:",label,count,label);
+        exportcount = 0;
+    }
+    for(x=0;x<4;x++)
+    {
+        for(t=0;t<count;t++) { export_byte(table[x][t]); }
+    }
+    return 0;
+}
+
+int export_file(const char* dir, const char* name, const char* extension, const char* label, const char* description, unsigned char* data, unsigned int width, unsigned int height, int encoding)
+{
+    // Host version of export_file() in main.c
+    // Input: output directory, project name, extension, label and description of the data, data and its size
+    // Output: 0 if no error
+
+    char fulllabel[PATH_MAX_LENGTH];
+    unsigned int x;
+    int error = 0;
+
+    snprintf(path,PATH_MAX_LENGTH,"%s/%s.%s%s",dir,name,extension,exportasm? ".s" : "");
+    exportfile = fopen(path,"wb");
+    if(!exportfile)
+    {
+        fprintf(stderr,"%s: can not create %s.\n",name,path);
+        return 1;
+    }
+
+    exportcount = 0;
+    snprintf(fulllabel,PATH_MAX_LENGTH,"%s_%s",label,extension);
+    if(exportasm)
+    {
+        fprintf(exportfile,"; tedse export of %s: %s, %ux%u, %s\n",name,description,width,height,(encoding == EXPORT_RAW)? "raw" : (encoding == EXPORT_RLE)? "rle" : "tiles");
+        fprintf(exportfile,"%s_width = %u\n%s_height = %u\n",fulllabel,width,fulllabel,height);
+        fprintf(exportfile,"%s:",fulllabel);
+    }
+
+    if(encoding == EXPORT_TILES)
+    {
+        error = export_tiles(data,width,height,fulllabel);
+    }
+    else if(encoding == EXPORT_RLE)
+    {
+        packedsize = rle_pack_blocks(data,packed,width*height);
+        for(x=0;x<packedsize;x++) { export_byte(packed[x]); }
+    }
+    else
+    {
+        for(x=0;x<width*height;x++) { export_byte(data[x]); }
+    }
+    if(exportasm) { export_text("\n"); }
+
+    if(fclose(exportfile) && !error)
+    {
+        fprintf(stderr,"%s: save error on writing %s.\n",name,path);
+        return 1;
+    }
+    if(error)
+    {
+        fprintf(stderr,"%s: too many different tiles for %s.\n",name,path);
+        remove(path);
+    }
+    return error;
+}
+
+int export_project(const char* dir, const char* name, const char* outdir, unsigned int screenwidth, unsigned int screenheight, unsigned char charsetchanged)
+{
+    // Export the screen map loaded at the start of mem and the charset in exportset, as exportdata() in main.c
+    // Output: 0 if no error
+
+    char label[PATH_MAX_LENGTH];
+    unsigned int total = screenwidth*screenheight;
+    char* ptr;
+
+    if(exportencoding == EXPORT_TILES && screenwidth > 255)
+    {
+        fprintf(stderr,"%s: tiles need width below 256.\n",name);
+        return 1;
+    }
+
+    // Label for the assembler from the filename
+    snprintf(label+1,PATH_MAX_LENGTH-1,"%s",name);
+    for(ptr=label+1;*ptr;ptr++)
+    {
+        if(!isalnum((unsigned char)*ptr)) { *ptr = '_'; } else { *ptr = tolower((unsigned char)*ptr); }
+    }
+    label[0] = '_';
+    ptr = isdigit((unsigned char)label[1])? label : label+1;
+
+    if(!outdir) { outdir = dir; }
+    if(export_file(outdir,name,"chr",ptr,"characters",mem+total+24,screenwidth,screenheight,exportencoding)) { return 1; }
+    if(export_file(outdir,name,"atr",ptr,"attributes",mem,screenwidth,screenheight,exportencoding)) { return 1; }
+    if(charsetchanged && export_file(outdir,name,"set",ptr,"charset",exportset,8,128,(exportencoding == EXPORT_TILES)? EXPORT_RLE : exportencoding)) { return 1; }
+
+    printf("%s: %ux%u, exported to %s/%s.chr%s.\n",name,screenwidth,screenheight,outdir,name,exportasm? ".s" : "");
+    return 0;
+}
+
+int load_data(const char* dir, const char* name, unsigned char container, long length, unsigned char charsetchanged, unsigned int datasize, unsigned int mapsize, unsigned char* map, unsigned char* charset)
+{
+    // Load screen map and charset: from the container in filebuffer, or from the .scrn and .chrs files of older versions
+    // Input: directory and name of the project, container flag and length of the project file,
+    //        size of the screen map data, size including padding to a full screen, destinations
+    // Output: 0 if no error
+
+    long offset;
+    unsigned long checksum;
+    unsigned int x;
+
+    if(container)
+    {
+        offset = PROJ_HEADERSIZE;
+        if(charsetchanged)
+        {
+            if(length < offset+CHAR_SIZE)
+            {
+                fprintf(stderr,"%s: load error on loading charset data.\n",name);
+                return 1;
+            }
+            memcpy(charset,filebuffer+offset,CHAR_SIZE);
+            offset += CHAR_SIZE;
+        }
+        if(rle_unpack(filebuffer+offset,length-offset,map,datasize))
+        {
+            fprintf(stderr,"%s: load error on loading screen data.\n",name);
+            return 1;
+        }
+
+        // Same 16 bit additive checksum as TED_Checksum(), over the charset if changed and the unpacked screen
+        for(checksum=0,x=0;x<datasize;x++) { checksum += map[x]; }
+        for(x=0;charsetchanged && x<CHAR_SIZE;x++) { checksum += charset[x]; }
+        if((checksum & 0xffff) != (unsigned int)(filebuffer[PROJ_CHECKSUM]*256+filebuffer[PROJ_CHECKSUM+1]))
+        {
+            fprintf(stderr,"%s: checksum error in project.\n",name);
+            return 1;
+        }
+    }
+    else
+    {
+        length = read_file(dir,name,"scrn");
+        if(length >= SCRN_HEADERSIZE && filebuffer[0] == SCRN_MAGIC0 && filebuffer[1] == SCRN_MAGIC1 && filebuffer[2] == SCRN_MAGIC2 && filebuffer[3] == SCRN_VERSION)
+        {
+            length = rle_unpack(filebuffer+SCRN_HEADERSIZE,length-SCRN_HEADERSIZE,map,datasize)? -1 : 0;
+        }
+        else if(length > 2)
+        {
+            // Raw screen file, skip load address
+            if(length-2 > (long)mapsize) { length = mapsize+2; }
+            memcpy(map,filebuffer+2,length-2);
+        }
+        else
+        {
+            length = -1;
+        }
+        if(length < 0)
+        {
+            fprintf(stderr,"%s: load error on loading screen data.\n",name);
+            return 1;
+        }
+        if(charsetchanged)
+        {
+            length = read_file(dir,name,"chrs");
+            if(length < CHAR_SIZE+2)
+            {
+                fprintf(stderr,"%s: load error on loading standard charset data.\n",name);
+                return 1;
+            }
+            memcpy(charset,filebuffer+2,CHAR_SIZE);
+        }
+    }
+    return 0;
+}
+
+void charset_start(unsigned char* charset)
+{
+    // Host version of charset_start() in prggenerator.c
+
+    memcpy(charsetoriginal,charset,CHAR_SIZE);
+    memset(glyphmap,0xff,sizeof(glyphmap));
+    glyphs = 0;
+}
+
+void charset_remap(unsigned char* chars, unsigned int length)
+{
+    // Host version of charset_remap() in prggenerator.c, should produce identical output
+
+    unsigned char* end = chars + length;
+    unsigned char* bitmap;
+    unsigned char glyph;
+    unsigned int x;
+
+    for(;chars<end;chars++)
+    {
+        glyph = *chars & 0x7f;
+        if(glyphmap[glyph] == 0xff)
+        {
+            bitmap = charsetoriginal + glyph*8;
+            for(x=0;x<glyphs && memcmp(charsetcompact+x*8,bitmap,8);x++) {}
+            if(x == glyphs)
+            {
+                memcpy(charsetcompact+x*8,bitmap,8);
+                glyphs++;
+            }
+            glyphmap[glyph] = x;
+        }
+        *chars = (*chars & 0x80) | glyphmap[glyph];
+    }
+}
+
+int generate_callable(const char* dir, const char* name, const char* outdir, unsigned char container, long length, unsigned char* meta)
+{
+    // Build a callable routine for one project, same steps as generate_callable() in prggenerator.c
+    // Input: directory and name of the project, output directory, container flag and length of project file, metadata
+    // Output: 0 if no error
+
+    unsigned char charsetchanged = meta[0];
+    unsigned int staging = GENERATORBASE-SCREEN_SIZE-CHAR_SIZE;
+    unsigned int block = loadaddress+CALL_BLOCK-BASEADDRESS;
+    unsigned int address = BASEADDRESS+CALL_SIZE;
+    unsigned long end;
+    FILE* file;
+
+    if(meta[4]*256+meta[5] != 40 || meta[6]*256+meta[7] != 25)
+    {
+        fprintf(stderr,"%s: callable routine needs a 40x25 screen.\n",name);
+        return 1;
+    }
+    memset(mem,0,sizeof(mem));
+    memcpy(mem+BASEADDRESS,runtime,runtimesize);
+    mem[CALL_BLOCKLO] = block & 0xff;
+    mem[CALL_BLOCKHI] = (block>>8) & 0xff;
+    mem[CALL_SCREEN] = callscreen>>8;
+    mem[CALL_CHARSET] = charsetchanged? callcharset>>8 : 0;
+    mem[CALL_LOWER] = meta[1];
+    mem[CALL_BGCOLOR] = meta[10];
+    mem[CALL_BORDER] = meta[20];
+
+    // Load screen and charset, pack them after the routine
+    if(load_data(dir,name,container,length,charsetchanged,40*25*2+24,SCREEN_SIZE,mem+staging,mem+staging+SCREEN_SIZE)) { return 1; }
+    if(charsetchanged)
+    {
+        charset_start(mem+staging+SCREEN_SIZE);
+        charset_remap(mem+staging+40*25+24,40*25);
+    }
+    packedsize = rle_pack(mem+staging,packed,40*25*2+24,NULL);
+    memcpy(mem+address,packed,packedsize);
+    address += packedsize;
+    if(charsetchanged)
+    {
+        packedsize = rle_pack(charsetcompact,packed,glyphs*8,NULL);
+        memcpy(mem+address,packed,packedsize);
+        address += packedsize;
+    }
+
+    // The routine must not overwrite itself when it shows the screen
+    end = (unsigned long)loadaddress+address-BASEADDRESS;
+    if(end > 0xFD00 || (loadaddress < (unsigned long)callscreen+SCREEN_SIZE && end > callscreen) ||
+       (charsetchanged && loadaddress < (unsigned long)callcharset+glyphs*8 && end > callcharset))
+    {
+        fprintf(stderr,"%s: routine from %4X to %5lX overlaps screen, charset or I/O.\n",name,loadaddress,end);
+        return 1;
+    }
+
+    snprintf(path,PATH_MAX_LENGTH,"%s/%s.prg",outdir? outdir : dir,name);
+    file = fopen(path,"wb");
+    if(!file)
+    {
+        fprintf(stderr,"%s: can not create %s.\n",name,path);
+        return 1;
+    }
+    fputc(loadaddress & 0xff,file);
+    fputc((loadaddress>>8) & 0xff,file);
+    fwrite(mem+BASEADDRESS,1,address-BASEADDRESS,file);
+    if(fclose(file))
+    {
+        fprintf(stderr,"%s: save error on writing %s.\n",name,path);
+        return 1;
+    }
+
+    printf("%s: callable routine, %u glyphs, created %s from %4X to %4lX.\n",name,charsetchanged? glyphs : 0,path,loadaddress,end);
+    return 0;
+}
+
+int generate(const char* dir, const char* name, const char* outdir)
+{
+    // Build the program of one project, same steps as generate_screen() in prggenerator.c
+    // Input: directory and name without .proj of the project, output directory
+    // Output: 0 if no error
+
+    unsigned char meta[PROJ_METASIZE];
+    unsigned char container;
+    unsigned char charsetchanged, charsetlowercase, screenbackground, screenborder;
+    unsigned int screenwidth, screenheight, mapsize, address, runtimeend, charsetstart, payload, x;
+    unsigned char aligned;
+    unsigned long mapend;
+    long length;
+    FILE* file;
+
+    // Load project variables from container file, or from .proj file of older versions
+    length = read_file(dir,name,"proj");
+    if(length < 0)
+    {
+        fprintf(stderr,"%s: can not open project file.\n",name);
+        return 1;
+    }
+    container = length >= PROJ_HEADERSIZE && filebuffer[0] == PROJ_MAGIC0 && filebuffer[1] == PROJ_MAGIC1 && filebuffer[2] == PROJ_MAGIC2 && filebuffer[3] == PROJ_VERSION;
+    if(!container && length < PROJ_METASIZE+2)
+    {
+        fprintf(stderr,"%s: read error on reading project file.\n",name);
+        return 1;
+    }
+    memcpy(meta,filebuffer+(container? 4 : 2),PROJ_METASIZE);
+    charsetchanged          = meta[ 0];
+    charsetlowercase        = meta[ 1];
+    screenwidth             = meta[ 4]*256+meta[ 5];
+    screenheight            = meta[ 6]*256+meta[ 7];
+    screenbackground        = meta[10];
+    screenborder            = meta[20];
+
+    if(screenwidth<40 || screenheight<25)
+    {
+        fprintf(stderr,"%s: screen smaller than 40x25 not supported.\n",name);
+        return 1;
+    }
+
+    if(exportencoding >= 0)
+    {
+        mapend = (unsigned long)screenwidth*screenheight*2+24;
+        if(mapend > sizeof(mem))
+        {
+            fprintf(stderr,"%s: screen too large.\n",name);
+            return 1;
+        }
+        if(load_data(dir,name,container,length,charsetchanged,mapend,(mapend < SCREEN_SIZE)? SCREEN_SIZE : mapend,mem,exportset)) { return 1; }
+        return export_project(dir,name,outdir,screenwidth,screenheight,charsetchanged);
+    }
+    if(callable)
+    {
+        return generate_callable(dir,name,outdir,container,length,meta);
+    }
+
+    // Runtime and version string
+    memset(mem,0,sizeof(mem));
+    memcpy(mem+BASEADDRESS,runtime,runtimesize);
+    for(x=0;x<22;x++)
+    {
+        mem[BASEADDRESS+VERSIONADDRESS+x] = versionstring[x];
+    }
+
+    // Place a 40x25 screen on a 2K boundary and the charset on a 1K boundary, or directly after the runtime if that does not fit
+    runtimeend = mem[MAPADDRESS]+256*mem[MAPADDRESS+1];
+    mapend = (unsigned long)screenwidth*screenheight*2+24;
+    mapsize = (mapend < SCREEN_SIZE)? SCREEN_SIZE : (unsigned int)mapend;
+    address = (screenwidth==40 && screenheight==25)? (runtimeend+0x7FF) & 0xF800 : runtimeend;
+    charsetstart = charsetchanged? (address+mapsize+0x3FF) & 0xFC00 : address+mapsize;
+    mapend = charsetstart + (unsigned long)(charsetchanged? CHAR_SIZE : 0);
+    aligned = 1;
+    if(mapend > GENERATORBASE)
+    {
+        address = runtimeend;
+        charsetstart = address+mapsize;
+        mapend = charsetstart + (unsigned long)(charsetchanged? CHAR_SIZE : 0);
+        aligned = 0;
+    }
+    if(mapend > GENERATORBASE)
+    {
+        fprintf(stderr,"%s: screen too large, program would end at %5lX.\n",name,mapend);
+        return 1;
+    }
+    pokew(MAPADDRESS,address);
+    if(aligned && screenwidth==40 && screenheight==25)
+    {
+        mem[SCREENBASE_ADDR] = address>>8;
+    }
+    mem[BGCOLORADDRESS] = screenbackground;
+    mem[BORDERCOLORADDR] = screenborder;
+    mem[CHARSET_LOWER] = charsetlowercase;
+    pokew(MAPWIDTH_ADDR,screenwidth);
+    pokew(MAPMAXX_ADDR,screenwidth-40);
+    pokew(MAPMAXY_ADDR,screenheight-25);
+    pokew(MAPPLANE_ADDR,screenwidth*screenheight+24);
+
+    if(load_data(dir,name,container,length,charsetchanged,screenwidth*screenheight*2+24,mapsize,mem+address,mem+charsetstart)) { return 1; }
+    payload = address;
+    address = charsetstart;
+
+    // Set standard charset if defined
+    if(charsetchanged)
+    {
+        // Keep only the glyphs the screen uses, once each
+        charset_start(mem+charsetstart);
+        charset_remap(mem+payload+screenwidth*screenheight+24,screenwidth*screenheight);
+        memcpy(mem+charsetstart,charsetcompact,glyphs*8);
+        pokew(CHARSET_ADDRESS,address);
+        if(aligned)
+        {
+            mem[CHARSET_DEST] = address>>8;
+        }
+        else
+        {
+            mem[CHARSET_DEST] = (address+CHAR_SIZE <= CHARSET_COPY)? CHARSET_COPY>>8 : ((address+CHAR_SIZE+0x3FF)>>8) & 0xFC;
+        }
+        address+=glyphs*8;
+    }
+
+    // Pack screen map and charset
+    packedsize = rle_pack(mem+payload,packed,address-payload,&packedgap);
+    if(packedsize < address-runtimeend && (unsigned long)payload+packedgap+packedsize <= GENERATORBASE)
+    {
+        pokew(PACKEDSIZE_ADDR,packedsize);
+        pokew(PACKEDTOP_ADDR,payload+packedgap);
+    }
+    else
+    {
+        packedsize = 0;
+    }
+
+    // Save complete generated program: load address, runtime and packed or unpacked payload
+    snprintf(path,PATH_MAX_LENGTH,"%s/%s.prg",outdir? outdir : dir,name);
+    file = fopen(path,"wb");
+    if(!file)
+    {
+        fprintf(stderr,"%s: can not create %s.\n",name,path);
+        return 1;
+    }
+    fputc(BASEADDRESS & 0xff,file);
+    fputc((BASEADDRESS>>8) & 0xff,file);
+    fwrite(mem+BASEADDRESS,1,runtimeend-BASEADDRESS,file);
+    if(packedsize)
+    {
+        fwrite(packed,1,packedsize,file);
+    }
+    else
+    {
+        fwrite(mem+runtimeend,1,address-runtimeend,file);
+    }
+    if(fclose(file))
+    {
+        fprintf(stderr,"%s: save error on writing %s.\n",name,path);
+        return 1;
+    }
+
+    printf("%s: %ux%u, %u glyphs, %s, created %s up to %4X.\n",name,screenwidth,screenheight,charsetchanged? glyphs : 0,packedsize? "packed" : "unpacked",path,packedsize? runtimeend+packedsize : address);
+    return 0;
+}
+
+int project_name(const char* filename, char* dir, char* name)
+{
+    // Split a project path in directory and name without .proj or .proj.prg
+    // Input: project path
+    // Output: 1 if the path has a project extension, 0 if not. Directory and name filled in both cases
+
+    const char* base = strrchr(filename,'/');
+    size_t length;
+    int found = 0;
+
+    if(base)
+    {
+        length = base - filename;
+        if(length >= PATH_MAX_LENGTH) { length = PATH_MAX_LENGTH-1; }
+        memcpy(dir,filename,length);
+        dir[length] = 0;
+        if(!length) { strcpy(dir,"/"); }
+        base++;
+    }
+    else
+    {
+        strcpy(dir,".");
+        base = filename;
+    }
+    snprintf(name,PATH_MAX_LENGTH,"%s",base);
+    length = strlen(name);
+    if(length > 9 && !strcmp(name+length-9,".proj.prg")) { name[length-9] = 0; found = 1; }
+    else if(length > 5 && !strcmp(name+length-5,".proj")) { name[length-5] = 0; found = 1; }
+    return found;
+}
+
+int main(int argc, char* argv[])
+{
+    FILE* file;
+    DIR* directory;
+    struct dirent* entry;
+    char* runtimefile = NULL;
+    char* outdir = NULL;
+    char dir[PATH_MAX_LENGTH];
+    char name[PATH_MAX_LENGTH];
+    char entrypath[PATH_MAX_LENGTH];
+    size_t namelength;
+    long length;
+    int arg, x;
+    unsigned int converted = 0, failed = 0;
+
+    // Options
+    for(arg=1;arg<argc-1 && argv[arg][0]=='-';arg+=2)
+    {
+        if(!strcmp(argv[arg],"-a")) { runtimefile = argv[arg+1]; }
+        else if(!strcmp(argv[arg],"-o")) { outdir = argv[arg+1]; }
+        else if(!strcmp(argv[arg],"-x") && !strcmp(argv[arg+1],"raw"))   { exportencoding = EXPORT_RAW; }
+        else if(!strcmp(argv[arg],"-x") && !strcmp(argv[arg+1],"rle"))   { exportencoding = EXPORT_RLE; }
+        else if(!strcmp(argv[arg],"-x") && !strcmp(argv[arg+1],"tiles")) { exportencoding = EXPORT_TILES; }
+        else if(!strcmp(argv[arg],"-f") && !strcmp(argv[arg+1],"asm"))   { exportasm = 1; }
+        else if(!strcmp(argv[arg],"-f") && !strcmp(argv[arg+1],"bin"))   { exportasm = 0; }
+        else if(!strcmp(argv[arg],"-c")) { callable = 1; loadaddress = strtoul(argv[arg+1],NULL,16); }
+        else if(!strcmp(argv[arg],"-s")) { callscreen = strtoul(argv[arg+1],NULL,16); }
+        else if(!strcmp(argv[arg],"-k")) { callcharset = strtoul(argv[arg+1],NULL,16); }
+        else { break; }
+    }
+    if(arg >= argc || argv[arg][0]=='-')
+    {
+        fprintf(stderr,"Usage: %s [-a <runtime PRG>] [-o <output directory>] [-x raw|rle|tiles] [-f asm|bin]\n"
+                       "       [-c <load address> [-s <screen address>] [-k <charset address>]] <project or directory> [...]\n",argv[0]);
+        return 1;
+    }
+    if(!callscreen || !callcharset || (callscreen & (SCREEN_SIZE-1)) || (callcharset & (CHAR_SIZE-1)))
+    {
+        fprintf(stderr,"Screen address must be 2K aligned, charset address 1K aligned, both not 0.\n");
+        return 1;
+    }
+    if(!runtimefile) { runtimefile = callable? "tedse2prg.call.prg" : "tedse2prg.ass.prg"; }
+
+    // Load runtime, skipping its load address. Not needed to export data
+    if(exportencoding < 0)
+    {
+        file = fopen(runtimefile,"rb");
+        if(!file)
+        {
+            fprintf(stderr,"Can not open %s.\n",runtimefile);
+            return 1;
+        }
+        length = fread(runtime,1,sizeof(runtime),file);
+        fclose(file);
+        if(length-2 < (callable? CALL_SIZE : MAPADDRESS-BASEADDRESS+2) || length-2 > GENERATORBASE-BASEADDRESS)
+        {
+            fprintf(stderr,"%s is not a valid runtime.\n",runtimefile);
+            return 1;
+        }
+        runtimesize = length-2;
+        memmove(runtime,runtime+2,runtimesize);
+
+        // The runtime should be the one this tool was built for: same size and screen data directly after its code
+        if(runtimesize != (callable? CALL_SIZE : ASS_SIZE-2) ||
+           (!callable && runtime[MAPADDRESS-BASEADDRESS]+256*runtime[MAPADDRESS-BASEADDRESS+1] != BASEADDRESS+runtimesize-4))
+        {
+            fprintf(stderr,"%s: runtime does not match this version.\n",runtimefile);
+            return 1;
+        }
+    }
+
+    // Version string in PETSCII, lowercase letters are unshifted
+    snprintf(versionstring,sizeof(versionstring),
+            "v%2i.%2i - %c%c%c%c%c%c%c%c-%c%c%c%c",
+            VERSION_MAJOR, VERSION_MINOR,
+            BUILD_YEAR_CH0, BUILD_YEAR_CH1, BUILD_YEAR_CH2, BUILD_YEAR_CH3, BUILD_MONTH_CH0, BUILD_MONTH_CH1, BUILD_DAY_CH0, BUILD_DAY_CH1,BUILD_HOUR_CH0, BUILD_HOUR_CH1, BUILD_MIN_CH0, BUILD_MIN_CH1);
+    for(x=0;versionstring[x];x++)
+    {
+        versionstring[x] = toupper((unsigned char)versionstring[x]);
+    }
+
+    // Convert projects and all projects in directories
+    for(;arg<argc;arg++)
+    {
+        directory = opendir(argv[arg]);
+        if(directory)
+        {
+            while((entry = readdir(directory)) != NULL)
+            {
+                snprintf(entrypath,PATH_MAX_LENGTH,"%s/%s",argv[arg],entry->d_name);
+                if(project_name(entrypath,dir,name))
+                {
+                    // An extracted name.proj.prg next to name.proj is the same project, convert it only once
+                    namelength = strlen(entrypath);
+                    if(namelength > 9 && !strcmp(entrypath+namelength-9,".proj.prg"))
+                    {
+                        entrypath[namelength-4] = 0;
+                        file = fopen(entrypath,"rb");
+                        if(file)
+                        {
+                            fclose(file);
+                            continue;
+                        }
+                    }
+                    if(generate(dir,name,outdir)) { failed++; } else { converted++; }
+                }
+            }
+            closedir(directory);
+        }
+        else
+        {
+            project_name(argv[arg],dir,name);
+            if(generate(dir,name,outdir)) { failed++; } else { converted++; }
+        }
+    }
+
+    printf("Converted %u projects, %u failed.\n",converted,failed);
+    return failed? 1 : 0;
+}
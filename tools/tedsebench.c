@@ -0,0 +1,811 @@
+/*
+TED Screen Editor
+Cycle benchmark for the core assembly routines, runs on the build host
+Written in 2022 by Xander Mol
+
+https://github.com/xahmol/TEDScreenEdit
+https://www.idreamtin8bits.com/
+
+Runs the routines of src/ted_core_assembly.s in a 6502 simulator with the
+Plus/4 memory map and reports the exact number of cycles per routine and
+viewport size, from the first instruction up to and including the RTS.
+Cycles taken by the TED for screen fetches are not counted.
+
+Usage: tedsebench [-w] [-b <baseline file>] <binary> <label file>
+
+The binary and the VICE label file are made with ca65 and ld65 using
+tools/tedsebench.cfg, which links the code at BENCH_CODE. The results of every
+run are checked against what the routine should have written in memory.
+
+With -b the counts are compared with the baseline file and the exit code is 1
+if a routine takes more cycles than in the baseline or writes wrong results.
+With -w as well the baseline file is written with the new counts instead.
+*/
+
+//Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_CODE          0x2000      // Link address of code, equal to start in tools/tedsebench.cfg
+#define BENCH_MAXCYCLES     10000000UL  // Cycles after which a routine is considered hanging
+#define BENCH_RETURN        0xffff      // Return address to detect end of routine
+#define BENCH_MAXLABELS     256         // Maximum number of labels read
+#define COLORMEMORY         0x0800      // Color memory base address, as in defines.h
+#define CHARSET             0xA800      // Base address for redefined charset, as in defines.h
+#define SCREENMAPBASE       0xAC00      // Base address for screen map, as in defines.h
+#define ROMCHARSET          0xD000      // Charset in ROM
+#define MAPWIDTH            80          // Width of screen map to copy viewports from
+#define MAPHEIGHT           25          // Height of screen map to copy viewports from
+
+// Routines and the way they are called, as by the C functions in src/ted_core.c
+enum { BENCH_FILL, BENCH_COPY, BENCH_PAGED, BENCH_LEFT, BENCH_RIGHT, BENCH_DOWN, BENCH_UP, BENCH_ROMCOPY };
+
+struct BenchCase {
+    const char* routine;                // Exported label of routine
+    int kind;                           // Way of calling
+    unsigned char width;                // Viewport width
+    unsigned char height;               // Viewport height, or number of pages for ROM copy
+};
+
+// Viewport sizes as used by TEDSE: status line, menu popup, help window and full screen
+struct BenchCase cases[] = {
+    { "_TED_FillArea_core",                  BENCH_FILL,    40,  1 },
+    { "_TED_FillArea_core",                  BENCH_FILL,    13, 12 },
+    { "_TED_FillArea_core",                  BENCH_FILL,    34, 21 },
+    { "_TED_FillArea_core",                  BENCH_FILL,    40, 25 },
+    { "_TED_CopyViewPortToTED_core",         BENCH_COPY,    40,  1 },
+    { "_TED_CopyViewPortToTED_core",         BENCH_COPY,    20, 12 },
+    { "_TED_CopyViewPortToTED_core",         BENCH_COPY,    40, 25 },
+    { "_TED_CopyViewPortToTED_paged_core",   BENCH_PAGED,   40,  1 },
+    { "_TED_CopyViewPortToTED_paged_core",   BENCH_PAGED,   20, 12 },
+    { "_TED_CopyViewPortToTED_paged_core",   BENCH_PAGED,   40, 25 },
+    { "_TED_Scroll_left_core",               BENCH_LEFT,    20, 12 },
+    { "_TED_Scroll_left_core",               BENCH_LEFT,    40, 25 },
+    { "_TED_Scroll_right_core",              BENCH_RIGHT,   20, 12 },
+    { "_TED_Scroll_right_core",              BENCH_RIGHT,   40, 25 },
+    { "_TED_Scroll_down_core",               BENCH_DOWN,    20, 12 },
+    { "_TED_Scroll_down_core",               BENCH_DOWN,    40, 25 },
+    { "_TED_Scroll_up_core",                 BENCH_UP,      20, 12 },
+    { "_TED_Scroll_up_core",                 BENCH_UP,      40, 25 },
+    { "_TED_ROM_Memcopy_core",               BENCH_ROMCOPY,  0,  4 },
+    { "_TED_ROM_Memcopy_core",               BENCH_ROMCOPY,  0,  8 },
+};
+
+#define BENCH_CASES (sizeof(cases)/sizeof(cases[0]))
+
+// Memory: RAM, ROM visible from $8000 after a write to $FF3E, TED registers at $FF00-$FF3F
+unsigned char ram[0x10000];
+unsigned char rom[0x10000];
+unsigned char ted[0x40];
+unsigned char romselect;
+unsigned char initial[0x10000];         // RAM with code and test data at start of every run
+unsigned char expect[0x10000];          // RAM as it should be after a run
+
+// Labels from label file
+char labelname[BENCH_MAXLABELS][64];
+unsigned int labeladdress[BENCH_MAXLABELS];
+unsigned int labels;
+
+// Baseline
+char baselinename[BENCH_CASES][80];
+unsigned long baselinecycles[BENCH_CASES];
+unsigned int baselines;
+
+// CPU registers and cycle counter
+unsigned char rega, regx, regy, regsp, regp;
+unsigned int regpc;
+unsigned long cycles;
+
+// Processor status flags
+#define FLAG_C  0x01
+#define FLAG_Z  0x02
+#define FLAG_I  0x04
+#define FLAG_D  0x08
+#define FLAG_B  0x10
+#define FLAG_U  0x20
+#define FLAG_V  0x40
+#define FLAG_N  0x80
+
+// Addressing modes
+enum { M_IMP, M_ACC, M_IMM, M_ZP, M_ZPX, M_ZPY, M_ABS, M_ABX, M_ABY, M_IND, M_IZX, M_IZY, M_REL };
+
+// Instructions
+enum {
+    I_ADC, I_AND, I_ASL, I_BCC, I_BCS, I_BEQ, I_BIT, I_BMI, I_BNE, I_BPL, I_BRK, I_BVC, I_BVS, I_CLC,
+    I_CLD, I_CLI, I_CLV, I_CMP, I_CPX, I_CPY, I_DEC, I_DEX, I_DEY, I_EOR, I_INC, I_INX, I_INY, I_JMP,
+    I_JSR, I_LDA, I_LDX, I_LDY, I_LSR, I_NOP, I_ORA, I_PHA, I_PHP, I_PLA, I_PLP, I_ROL, I_ROR, I_RTI,
+    I_RTS, I_SBC, I_SEC, I_SED, I_SEI, I_STA, I_STX, I_STY, I_TAX, I_TAY, I_TSX, I_TXA, I_TXS, I_TYA,
+    I_ILLEGAL
+};
+
+struct Opcode {
+    unsigned char instruction;
+    unsigned char mode;
+    unsigned char opcode;
+};
+
+// Documented NMOS 6502 opcodes
+struct Opcode opcodelist[] = {
+    {I_ADC,M_IMM,0x69},{I_ADC,M_ZP,0x65},{I_ADC,M_ZPX,0x75},{I_ADC,M_ABS,0x6d},{I_ADC,M_ABX,0x7d},{I_ADC,M_ABY,0x79},{I_ADC,M_IZX,0x61},{I_ADC,M_IZY,0x71},
+    {I_AND,M_IMM,0x29},{I_AND,M_ZP,0x25},{I_AND,M_ZPX,0x35},{I_AND,M_ABS,0x2d},{I_AND,M_ABX,0x3d},{I_AND,M_ABY,0x39},{I_AND,M_IZX,0x21},{I_AND,M_IZY,0x31},
+    {I_ASL,M_ACC,0x0a},{I_ASL,M_ZP,0x06},{I_ASL,M_ZPX,0x16},{I_ASL,M_ABS,0x0e},{I_ASL,M_ABX,0x1e},
+    {I_BCC,M_REL,0x90},{I_BCS,M_REL,0xb0},{I_BEQ,M_REL,0xf0},{I_BMI,M_REL,0x30},{I_BNE,M_REL,0xd0},{I_BPL,M_REL,0x10},{I_BVC,M_REL,0x50},{I_BVS,M_REL,0x70},
+    {I_BIT,M_ZP,0x24},{I_BIT,M_ABS,0x2c},
+    {I_BRK,M_IMP,0x00},{I_CLC,M_IMP,0x18},{I_CLD,M_IMP,0xd8},{I_CLI,M_IMP,0x58},{I_CLV,M_IMP,0xb8},
+    {I_CMP,M_IMM,0xc9},{I_CMP,M_ZP,0xc5},{I_CMP,M_ZPX,0xd5},{I_CMP,M_ABS,0xcd},{I_CMP,M_ABX,0xdd},{I_CMP,M_ABY,0xd9},{I_CMP,M_IZX,0xc1},{I_CMP,M_IZY,0xd1},
+    {I_CPX,M_IMM,0xe0},{I_CPX,M_ZP,0xe4},{I_CPX,M_ABS,0xec},
+    {I_CPY,M_IMM,0xc0},{I_CPY,M_ZP,0xc4},{I_CPY,M_ABS,0xcc},
+    {I_DEC,M_ZP,0xc6},{I_DEC,M_ZPX,0xd6},{I_DEC,M_ABS,0xce},{I_DEC,M_ABX,0xde},
+    {I_DEX,M_IMP,0xca},{I_DEY,M_IMP,0x88},
+    {I_EOR,M_IMM,0x49},{I_EOR,M_ZP,0x45},{I_EOR,M_ZPX,0x55},{I_EOR,M_ABS,0x4d},{I_EOR,M_ABX,0x5d},{I_EOR,M_ABY,0x59},{I_EOR,M_IZX,0x41},{I_EOR,M_IZY,0x51},
+    {I_INC,M_ZP,0xe6},{I_INC,M_ZPX,0xf6},{I_INC,M_ABS,0xee},{I_INC,M_ABX,0xfe},
+    {I_INX,M_IMP,0xe8},{I_INY,M_IMP,0xc8},
+    {I_JMP,M_ABS,0x4c},{I_JMP,M_IND,0x6c},{I_JSR,M_ABS,0x20},
+    {I_LDA,M_IMM,0xa9},{I_LDA,M_ZP,0xa5},{I_LDA,M_ZPX,0xb5},{I_LDA,M_ABS,0xad},{I_LDA,M_ABX,0xbd},{I_LDA,M_ABY,0xb9},{I_LDA,M_IZX,0xa1},{I_LDA,M_IZY,0xb1},
+    {I_LDX,M_IMM,0xa2},{I_LDX,M_ZP,0xa6},{I_LDX,M_ZPY,0xb6},{I_LDX,M_ABS,0xae},{I_LDX,M_ABY,0xbe},
+    {I_LDY,M_IMM,0xa0},{I_LDY,M_ZP,0xa4},{I_LDY,M_ZPX,0xb4},{I_LDY,M_ABS,0xac},{I_LDY,M_ABX,0xbc},
+    {I_LSR,M_ACC,0x4a},{I_LSR,M_ZP,0x46},{I_LSR,M_ZPX,0x56},{I_LSR,M_ABS,0x4e},{I_LSR,M_ABX,0x5e},
+    {I_NOP,M_IMP,0xea},
+    {I_ORA,M_IMM,0x09},{I_ORA,M_ZP,0x05},{I_ORA,M_ZPX,0x15},{I_ORA,M_ABS,0x0d},{I_ORA,M_ABX,0x1d},{I_ORA,M_ABY,0x19},{I_ORA,M_IZX,0x01},{I_ORA,M_IZY,0x11},
+    {I_PHA,M_IMP,0x48},{I_PHP,M_IMP,0x08},{I_PLA,M_IMP,0x68},{I_PLP,M_IMP,0x28},
+    {I_ROL,M_ACC,0x2a},{I_ROL,M_ZP,0x26},{I_ROL,M_ZPX,0x36},{I_ROL,M_ABS,0x2e},{I_ROL,M_ABX,0x3e},
+    {I_ROR,M_ACC,0x6a},{I_ROR,M_ZP,0x66},{I_ROR,M_ZPX,0x76},{I_ROR,M_ABS,0x6e},{I_ROR,M_ABX,0x7e},
+    {I_RTI,M_IMP,0x40},{I_RTS,M_IMP,0x60},
+    {I_SBC,M_IMM,0xe9},{I_SBC,M_ZP,0xe5},{I_SBC,M_ZPX,0xf5},{I_SBC,M_ABS,0xed},{I_SBC,M_ABX,0xfd},{I_SBC,M_ABY,0xf9},{I_SBC,M_IZX,0xe1},{I_SBC,M_IZY,0xf1},
+    {I_SEC,M_IMP,0x38},{I_SED,M_IMP,0xf8},{I_SEI,M_IMP,0x78},
+    {I_STA,M_ZP,0x85},{I_STA,M_ZPX,0x95},{I_STA,M_ABS,0x8d},{I_STA,M_ABX,0x9d},{I_STA,M_ABY,0x99},{I_STA,M_IZX,0x81},{I_STA,M_IZY,0x91},
+    {I_STX,M_ZP,0x86},{I_STX,M_ZPY,0x96},{I_STX,M_ABS,0x8e},
+    {I_STY,M_ZP,0x84},{I_STY,M_ZPX,0x94},{I_STY,M_ABS,0x8c},
+    {I_TAX,M_IMP,0xaa},{I_TAY,M_IMP,0xa8},{I_TSX,M_IMP,0xba},{I_TXA,M_IMP,0x8a},{I_TXS,M_IMP,0x9a},{I_TYA,M_IMP,0x98},
+};
+
+unsigned char decodeinstruction[256];
+unsigned char decodemode[256];
+unsigned char decodecycles[256];
+
+unsigned char base_cycles(unsigned char instruction, unsigned char mode)
+{
+    // Cycles of an instruction without page crossing and branch penalties
+    // Input: instruction and addressing mode
+    // Output: number of cycles
+
+    switch(instruction)
+    {
+    case I_STA: case I_STX: case I_STY:
+        switch(mode)
+        {
+        case M_ZP:  return 3;
+        case M_ABX: case M_ABY: return 5;
+        case M_IZX: case M_IZY: return 6;
+        default:    return 4;
+        }
+    case I_ASL: case I_LSR: case I_ROL: case I_ROR: case I_INC: case I_DEC:
+        switch(mode)
+        {
+        case M_ACC: return 2;
+        case M_ZP:  return 5;
+        case M_ABX: return 7;
+        default:    return 6;
+        }
+    case I_JMP: return mode == M_IND? 5 : 3;
+    case I_JSR: case I_RTS: case I_RTI: return 6;
+    case I_BRK: return 7;
+    case I_PHA: case I_PHP: return 3;
+    case I_PLA: case I_PLP: return 4;
+    default:
+        // Read instructions, implied instructions and branches
+        switch(mode)
+        {
+        case M_ZP:  return 3;
+        case M_ZPX: case M_ZPY: case M_ABS: case M_ABX: case M_ABY: return 4;
+        case M_IZX: return 6;
+        case M_IZY: return 5;
+        default:    return 2;
+        }
+    }
+}
+
+void cpu_init()
+{
+    // Build decoding tables from the opcode list
+
+    unsigned int x;
+
+    memset(decodeinstruction,I_ILLEGAL,sizeof(decodeinstruction));
+    for(x=0;x<sizeof(opcodelist)/sizeof(opcodelist[0]);x++)
+    {
+        decodeinstruction[opcodelist[x].opcode] = opcodelist[x].instruction;
+        decodemode[opcodelist[x].opcode] = opcodelist[x].mode;
+        decodecycles[opcodelist[x].opcode] = base_cycles(opcodelist[x].instruction,opcodelist[x].mode);
+    }
+}
+
+unsigned char mem_read(unsigned int address)
+{
+    // Read from the Plus/4 memory map
+
+    if(address >= 0xff00 && address < 0xff40) { return ted[address-0xff00]; }
+    if(romselect && address >= 0x8000 && (address < 0xfd00 || address >= 0xff40)) { return rom[address]; }
+    return ram[address];
+}
+
+void mem_write(unsigned int address, unsigned char value)
+{
+    // Write to the Plus/4 memory map, writes under ROM always go to RAM
+
+    if(address >= 0xff00 && address < 0xff40)
+    {
+        ted[address-0xff00] = value;
+        if(address == 0xff3e) { romselect = 1; }
+        if(address == 0xff3f) { romselect = 0; }
+        return;
+    }
+    ram[address] = value;
+}
+
+void push(unsigned char value)
+{
+    ram[0x100+regsp--] = value;
+}
+
+unsigned char pull()
+{
+    return ram[0x100+(++regsp & 0xff)];
+}
+
+unsigned char set_nz(unsigned char value)
+{
+    regp = (regp & ~(FLAG_N|FLAG_Z)) | (value & FLAG_N) | (value? 0 : FLAG_Z);
+    return value;
+}
+
+void compare(unsigned char reg, unsigned char value)
+{
+    set_nz(reg-value);
+    regp = (regp & ~FLAG_C) | (reg >= value? FLAG_C : 0);
+}
+
+void add(unsigned char value)
+{
+    // Binary add with carry, decimal mode is not used by the core routines and not simulated
+
+    unsigned int sum = rega + value + (regp & FLAG_C);
+
+    regp &= ~(FLAG_C|FLAG_V);
+    if(sum > 0xff) { regp |= FLAG_C; }
+    if(~(rega ^ value) & (rega ^ sum) & 0x80) { regp |= FLAG_V; }
+    rega = set_nz(sum & 0xff);
+}
+
+unsigned char shift(unsigned char instruction, unsigned char value)
+{
+    // Shift or rotate value for ASL, LSR, ROL and ROR
+
+    unsigned char carry = regp & FLAG_C;
+
+    if(instruction == I_ASL || instruction == I_ROL)
+    {
+        regp = (regp & ~FLAG_C) | (value >> 7);
+        value <<= 1;
+        if(instruction == I_ROL) { value |= carry; }
+    }
+    else
+    {
+        regp = (regp & ~FLAG_C) | (value & FLAG_C);
+        value >>= 1;
+        if(instruction == I_ROR) { value |= carry << 7; }
+    }
+    return set_nz(value);
+}
+
+int cpu_step()
+{
+    // Execute one instruction and count its cycles
+    // Output: 0 if executed, 1 at an illegal opcode
+
+    unsigned char opcode = mem_read(regpc);
+    unsigned char instruction = decodeinstruction[opcode];
+    unsigned char mode = decodemode[opcode];
+    unsigned int operand = regpc + 1;
+    unsigned int address = 0;
+    unsigned int base;
+    unsigned char value, taken;
+
+    if(instruction == I_ILLEGAL) { return 1; }
+    cycles += decodecycles[opcode];
+
+    // Effective address and page crossing penalty for read instructions
+    switch(mode)
+    {
+    case M_IMP: case M_ACC:
+        regpc += 1;
+        break;
+    case M_IMM:
+        address = operand;
+        regpc += 2;
+        break;
+    case M_ZP:
+        address = mem_read(operand);
+        regpc += 2;
+        break;
+    case M_ZPX:
+        address = (mem_read(operand) + regx) & 0xff;
+        regpc += 2;
+        break;
+    case M_ZPY:
+        address = (mem_read(operand) + regy) & 0xff;
+        regpc += 2;
+        break;
+    case M_IZX:
+        base = (mem_read(operand) + regx) & 0xff;
+        address = mem_read(base) | (mem_read((base+1) & 0xff) << 8);
+        regpc += 2;
+        break;
+    case M_IZY:
+        base = mem_read(operand);
+        base = mem_read(base) | (mem_read((base+1) & 0xff) << 8);
+        address = (base + regy) & 0xffff;
+        if(instruction != I_STA && (base & 0xff00) != (address & 0xff00)) { cycles++; }
+        regpc += 2;
+        break;
+    case M_REL:
+        value = mem_read(operand);
+        regpc += 2;
+        address = (regpc + (value & 0x80? value - 0x100 : value)) & 0xffff;
+        break;
+    default:
+        base = mem_read(operand) | (mem_read(operand+1) << 8);
+        regpc += 3;
+        if(mode == M_ABS) { address = base; }
+        if(mode == M_IND) { address = mem_read(base) | (mem_read((base & 0xff00) | ((base+1) & 0xff)) << 8); }
+        if(mode == M_ABX || mode == M_ABY)
+        {
+            address = (base + (mode == M_ABX? regx : regy)) & 0xffff;
+            if(decodecycles[opcode] == 4 && (base & 0xff00) != (address & 0xff00)) { cycles++; }
+        }
+        break;
+    }
+    regpc &= 0xffff;
+
+    switch(instruction)
+    {
+    case I_ADC: add(mem_read(address)); break;
+    case I_SBC: add(~mem_read(address)); break;
+    case I_AND: rega = set_nz(rega & mem_read(address)); break;
+    case I_ORA: rega = set_nz(rega | mem_read(address)); break;
+    case I_EOR: rega = set_nz(rega ^ mem_read(address)); break;
+    case I_CMP: compare(rega,mem_read(address)); break;
+    case I_CPX: compare(regx,mem_read(address)); break;
+    case I_CPY: compare(regy,mem_read(address)); break;
+    case I_BIT:
+        value = mem_read(address);
+        regp = (regp & ~(FLAG_N|FLAG_V|FLAG_Z)) | (value & (FLAG_N|FLAG_V)) | ((rega & value)? 0 : FLAG_Z);
+        break;
+    case I_LDA: rega = set_nz(mem_read(address)); break;
+    case I_LDX: regx = set_nz(mem_read(address)); break;
+    case I_LDY: regy = set_nz(mem_read(address)); break;
+    case I_STA: mem_write(address,rega); break;
+    case I_STX: mem_write(address,regx); break;
+    case I_STY: mem_write(address,regy); break;
+    case I_ASL: case I_LSR: case I_ROL: case I_ROR:
+        if(mode == M_ACC) { rega = shift(instruction,rega); }
+        else { mem_write(address,shift(instruction,mem_read(address))); }
+        break;
+    case I_INC: mem_write(address,set_nz(mem_read(address)+1)); break;
+    case I_DEC: mem_write(address,set_nz(mem_read(address)-1)); break;
+    case I_INX: regx = set_nz(regx+1); break;
+    case I_INY: regy = set_nz(regy+1); break;
+    case I_DEX: regx = set_nz(regx-1); break;
+    case I_DEY: regy = set_nz(regy-1); break;
+    case I_TAX: regx = set_nz(rega); break;
+    case I_TAY: regy = set_nz(rega); break;
+    case I_TXA: rega = set_nz(regx); break;
+    case I_TYA: rega = set_nz(regy); break;
+    case I_TSX: regx = set_nz(regsp); break;
+    case I_TXS: regsp = regx; break;
+    case I_PHA: push(rega); break;
+    case I_PHP: push(regp | FLAG_B | FLAG_U); break;
+    case I_PLA: rega = set_nz(pull()); break;
+    case I_PLP: regp = pull() | FLAG_U; break;
+    case I_CLC: regp &= ~FLAG_C; break;
+    case I_SEC: regp |= FLAG_C; break;
+    case I_CLD: regp &= ~FLAG_D; break;
+    case I_SED: regp |= FLAG_D; break;
+    case I_CLI: regp &= ~FLAG_I; break;
+    case I_SEI: regp |= FLAG_I; break;
+    case I_CLV: regp &= ~FLAG_V; break;
+    case I_NOP: break;
+    case I_JMP: regpc = address; break;
+    case I_JSR:
+        push(((regpc-1) >> 8) & 0xff);
+        push((regpc-1) & 0xff);
+        regpc = address;
+        break;
+    case I_RTS:
+        regpc = pull();
+        regpc = ((regpc | (pull() << 8)) + 1) & 0xffff;
+        break;
+    case I_RTI:
+        regp = pull() | FLAG_U;
+        regpc = pull();
+        regpc |= pull() << 8;
+        break;
+    case I_BRK:
+        // No interrupts in the benchmark, treat as illegal
+        return 1;
+    default:
+        // Branches: one extra cycle if taken, another if to another page
+        switch(instruction)
+        {
+        case I_BCC: taken = !(regp & FLAG_C); break;
+        case I_BCS: taken = (regp & FLAG_C) != 0; break;
+        case I_BNE: taken = !(regp & FLAG_Z); break;
+        case I_BEQ: taken = (regp & FLAG_Z) != 0; break;
+        case I_BPL: taken = !(regp & FLAG_N); break;
+        case I_BMI: taken = (regp & FLAG_N) != 0; break;
+        case I_BVC: taken = !(regp & FLAG_V); break;
+        default:    taken = (regp & FLAG_V) != 0; break;
+        }
+        if(taken)
+        {
+            cycles += ((regpc & 0xff00) != (address & 0xff00))? 2 : 1;
+            regpc = address;
+        }
+        break;
+    }
+    return 0;
+}
+
+int cpu_call(unsigned int address)
+{
+    // Run subroutine until its RTS, adding its cycles to the cycle counter
+    // Input: address of subroutine
+    // Output: 0 if returned, 1 at an illegal opcode or if hanging
+
+    unsigned long start = cycles;
+
+    regsp = 0xff;
+    regp = FLAG_U | FLAG_I;
+    push(((BENCH_RETURN-1) >> 8) & 0xff);
+    push((BENCH_RETURN-1) & 0xff);
+    regpc = address;
+    while(regpc != BENCH_RETURN)
+    {
+        if(cycles - start > BENCH_MAXCYCLES)
+        {
+            fprintf(stderr,"Routine at $%04X does not return.\n",address);
+            return 1;
+        }
+        if(cpu_step())
+        {
+            fprintf(stderr,"Illegal opcode at $%04X.\n",regpc);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int read_labels(const char* filename)
+{
+    // Read exported labels from a VICE label file as written by ld65 -Ln
+    // Input: filename
+    // Output: 0 if read
+
+    FILE* file = fopen(filename,"r");
+    char line[128];
+    char name[64];
+    unsigned int address;
+
+    if(!file)
+    {
+        fprintf(stderr,"Can not open %s.\n",filename);
+        return 1;
+    }
+    while(fgets(line,sizeof(line),file) && labels < BENCH_MAXLABELS)
+    {
+        if(sscanf(line,"al %x .%63s",&address,name) == 2)
+        {
+            strcpy(labelname[labels],name);
+            labeladdress[labels++] = address;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+unsigned int label(const char* name)
+{
+    // Address of label, exits if missing as the benchmark can not run without it
+
+    unsigned int x;
+
+    for(x=0;x<labels;x++)
+    {
+        if(!strcmp(labelname[x],name)) { return labeladdress[x]; }
+    }
+    fprintf(stderr,"Label %s not found.\n",name);
+    exit(1);
+}
+
+void poke_input(const char* name, unsigned char value)
+{
+    ram[label(name)] = value;
+}
+
+void set_address(const char* high, const char* low, unsigned int address)
+{
+    poke_input(high,(address>>8) & 0xff);
+    poke_input(low,address & 0xff);
+}
+
+int run_viewport_copy(const struct BenchCase* bench, unsigned int sourceplane)
+{
+    // Copy viewport at upper left of screen map to upper left of screen, as TED_CopyViewPortToTED()
+    // Input: benchmark case and offset of character data to attribute data in screen map
+    // Output: 0 if all calls returned
+
+    set_address("_TED_addrh","_TED_addrl",SCREENMAPBASE);
+    set_address("_TED_desth","_TED_destl",COLORMEMORY);
+    set_address("_TED_strideh","_TED_stridel",MAPWIDTH);
+    poke_input("_TED_tmp1",bench->height);
+    poke_input("_TED_tmp2",bench->width);
+    if(bench->kind == BENCH_PAGED)
+    {
+        poke_input("_TED_tmp3",(sourceplane>>8) & 0xff);
+        return cpu_call(label(bench->routine));
+    }
+    if(cpu_call(label(bench->routine))) { return 1; }
+    set_address("_TED_addrh","_TED_addrl",SCREENMAPBASE+sourceplane);
+    set_address("_TED_desth","_TED_destl",COLORMEMORY+0x0400);
+    poke_input("_TED_tmp1",bench->height);
+    poke_input("_TED_tmp2",bench->width);
+    return cpu_call(label(bench->routine));
+}
+
+int run(const struct BenchCase* bench)
+{
+    // Call the routine with its input set as by the C function in src/ted_core.c,
+    // and make the expected memory contents
+    // Input: benchmark case
+    // Output: 0 if all calls returned
+
+    unsigned int sourceplane = bench->kind == BENCH_PAGED? (MAPWIDTH*MAPHEIGHT+0xff) & 0xff00 : MAPWIDTH*MAPHEIGHT+24;
+    unsigned int plane, line, base;
+    int row;
+
+    memcpy(ram,initial,sizeof(ram));
+    memcpy(expect,initial,sizeof(expect));
+    memset(ted,0,sizeof(ted));
+    romselect = 0;
+    cycles = 0;
+
+    switch(bench->kind)
+    {
+    case BENCH_FILL:
+        for(line=0;line<bench->height;line++)
+        {
+            memset(expect+COLORMEMORY+line*40,0x71,bench->width);
+            memset(expect+COLORMEMORY+0x0400+line*40,0xa0,bench->width);
+        }
+        set_address("_TED_addrh","_TED_addrl",COLORMEMORY);
+        poke_input("_TED_tmp1",0xa0);
+        poke_input("_TED_tmp2",bench->width);
+        poke_input("_TED_tmp3",0x71);
+        poke_input("_TED_tmp4",bench->height);
+        return cpu_call(label(bench->routine));
+
+    case BENCH_COPY:
+    case BENCH_PAGED:
+        for(line=0;line<bench->height;line++)
+        {
+            memcpy(expect+COLORMEMORY+line*40,initial+SCREENMAPBASE+line*MAPWIDTH,bench->width);
+            memcpy(expect+COLORMEMORY+0x0400+line*40,initial+SCREENMAPBASE+sourceplane+line*MAPWIDTH,bench->width);
+        }
+        return run_viewport_copy(bench,sourceplane);
+
+    case BENCH_LEFT:
+    case BENCH_RIGHT:
+    case BENCH_DOWN:
+    case BENCH_UP:
+        // Scroll viewport at upper left of screen, planes in the same order as the routines
+        for(plane=0;plane<0x0800;plane+=0x0400)
+        {
+            for(row=0;row<bench->height;row++)
+            {
+                base = COLORMEMORY + plane + row*40;
+                if(bench->kind == BENCH_LEFT)  { memmove(expect+base,expect+base+1,bench->width-1); }
+                if(bench->kind == BENCH_RIGHT) { memmove(expect+base+1,expect+base,bench->width-1); }
+                if(bench->kind == BENCH_UP)    { memmove(expect+base,expect+base+40,bench->width); }
+                if(bench->kind == BENCH_DOWN)
+                {
+                    base = COLORMEMORY + plane + (bench->height-1-row)*40;
+                    memmove(expect+base,expect+base-40,bench->width);
+                }
+            }
+        }
+        base = COLORMEMORY;
+        if(bench->kind == BENCH_DOWN) { base += (bench->height-2)*40; }
+        if(bench->kind == BENCH_UP)   { base += 40; }
+        set_address("_TED_addrh","_TED_addrl",base);
+        poke_input("_TED_tmp1",bench->height);
+        poke_input("_TED_tmp2",bench->width);
+        return cpu_call(label(bench->routine));
+
+    default:
+        // Copy ROM charset to redefined charset, as at the start of TEDSE
+        memcpy(expect+CHARSET,rom+ROMCHARSET,bench->height*256);
+        set_address("_TED_addrh","_TED_addrl",ROMCHARSET);
+        set_address("_TED_desth","_TED_destl",CHARSET);
+        poke_input("_TED_tmp1",bench->height);
+        return cpu_call(label(bench->routine));
+    }
+}
+
+int check(const struct BenchCase* bench)
+{
+    // Compare memory after a run with the expected contents,
+    // skipping zero page, stack and the input and work variables of the routines
+    // Input: benchmark case
+    // Output: 0 if equal
+
+    unsigned int address;
+    unsigned int variables = label("_TED_addrh");
+    unsigned int variablesend = label("_TED_tmp4");
+
+    for(address=0x200;address<0x10000;address++)
+    {
+        if(address >= variables && address <= variablesend) { continue; }
+        if(ram[address] != expect[address])
+        {
+            fprintf(stderr,"%s: wrong value $%02X at $%04X, expected $%02X.\n",bench->routine,ram[address],address,expect[address]);
+            return 1;
+        }
+    }
+    return romselect;
+}
+
+void case_name(const struct BenchCase* bench, char* name)
+{
+    if(bench->kind == BENCH_ROMCOPY) { sprintf(name,"%s %upages",bench->routine,bench->height); }
+    else { sprintf(name,"%s %ux%u",bench->routine,bench->width,bench->height); }
+}
+
+int read_baseline(const char* filename)
+{
+    // Read baseline file, lines with routine, size and cycles, # for comments
+    // Input: filename
+    // Output: 0 if read
+
+    FILE* file = fopen(filename,"r");
+    char line[128];
+    char routine[64];
+    char size[16];
+    unsigned long count;
+
+    if(!file)
+    {
+        fprintf(stderr,"Can not open %s.\n",filename);
+        return 1;
+    }
+    while(fgets(line,sizeof(line),file) && baselines < BENCH_CASES)
+    {
+        if(line[0] == '#') { continue; }
+        if(sscanf(line,"%63s %15s %lu",routine,size,&count) == 3)
+        {
+            sprintf(baselinename[baselines],"%s %s",routine,size);
+            baselinecycles[baselines++] = count;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    FILE* file;
+    char* baselinefile = NULL;
+    int writebaseline = 0;
+    int arg;
+    unsigned int x, y, address;
+    unsigned long result[BENCH_CASES];
+    char name[BENCH_CASES][80];
+    unsigned int regressions = 0, improvements = 0, failures = 0;
+
+    // Options
+    for(arg=1;arg<argc && argv[arg][0]=='-';arg++)
+    {
+        if(!strcmp(argv[arg],"-w")) { writebaseline = 1; }
+        else if(!strcmp(argv[arg],"-b") && arg+1<argc) { baselinefile = argv[++arg]; }
+        else { break; }
+    }
+    if(argc-arg != 2 || argv[arg][0]=='-' || (writebaseline && !baselinefile))
+    {
+        fprintf(stderr,"Usage: %s [-w] [-b <baseline file>] <binary> <label file>\n",argv[0]);
+        return 1;
+    }
+
+    // Load code at link address
+    file = fopen(argv[arg],"rb");
+    if(!file)
+    {
+        fprintf(stderr,"Can not open %s.\n",argv[arg]);
+        return 1;
+    }
+    fread(initial+BENCH_CODE,1,sizeof(initial)-BENCH_CODE,file);
+    fclose(file);
+    if(read_labels(argv[arg+1])) { return 1; }
+    if(!writebaseline && baselinefile && read_baseline(baselinefile)) { return 1; }
+
+    // Test data: screen map and screen filled with a pattern that differs per line and plane,
+    // ROM with a pattern differing from RAM
+    for(address=0x0200;address<BENCH_CODE;address++)
+    {
+        initial[address] = (address * 7 + (address >> 8) * 13) & 0xff;
+    }
+    for(address=SCREENMAPBASE;address<0xfd00;address++)
+    {
+        initial[address] = (address * 11 + (address >> 7) * 5) & 0xff;
+    }
+    for(address=0x8000;address<0x10000;address++)
+    {
+        rom[address] = (address * 3 + (address >> 8) * 17 + 1) & 0xff;
+    }
+    cpu_init();
+
+    // Run all cases
+    printf("%-36s %7s %9s %9s\n","Routine","Size","Cycles","Baseline");
+    for(x=0;x<BENCH_CASES;x++)
+    {
+        case_name(&cases[x],name[x]);
+        if(run(&cases[x]) || check(&cases[x]))
+        {
+            fprintf(stderr,"%s: failed.\n",name[x]);
+            failures++;
+            result[x] = 0;
+            continue;
+        }
+        result[x] = cycles;
+        for(y=0;y<baselines && strcmp(baselinename[y],name[x]);y++);
+        printf("%-36s %7s %9lu ",cases[x].routine,strchr(name[x],' ')+1,result[x]);
+        if(y == baselines) { printf("%9s\n","-"); continue; }
+        printf("%9lu",baselinecycles[y]);
+        if(result[x] > baselinecycles[y]) { printf("  REGRESSION +%lu",result[x]-baselinecycles[y]); regressions++; }
+        if(result[x] < baselinecycles[y]) { printf("  improved -%lu",baselinecycles[y]-result[x]); improvements++; }
+        printf("\n");
+    }
+
+    if(failures)
+    {
+        fprintf(stderr,"%u routines failed.\n",failures);
+        return 1;
+    }
+
+    // Write new baseline
+    if(writebaseline)
+    {
+        file = fopen(baselinefile,"w");
+        if(!file)
+        {
+            fprintf(stderr,"Can not write %s.\n",baselinefile);
+            return 1;
+        }
+        fprintf(file,"# Cycle counts of src/ted_core_assembly.s routines for make bench\n");
+        fprintf(file,"# Written by tools/tedsebench -w, routine, viewport size and cycles per line\n");
+        for(x=0;x<BENCH_CASES;x++)
+        {
+            fprintf(file,"%s %lu\n",name[x],result[x]);
+        }
+        fclose(file);
+        printf("Baseline written to %s.\n",baselinefile);
+        return 0;
+    }
+
+    if(improvements) { printf("%u faster than baseline, update with make bench BENCHFLAGS=-w.\n",improvements); }
+    if(regressions)
+    {
+        fprintf(stderr,"%u slower than baseline.\n",regressions);
+        return 1;
+    }
+    return 0;
+}
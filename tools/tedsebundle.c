@@ -0,0 +1,102 @@
+/*
+TED Screen Editor
+Asset bundle builder, runs on the build host
+Written in 2022 by Xander Mol
+
+https://github.com/xahmol/TEDScreenEdit
+https://www.idreamtin8bits.com/
+
+Packs the startup assets (title screen, visual PETSCII map and help screens)
+into one PRG file, so TEDSE can read them with a single load at startup.
+
+Usage: tedsebundle <output file> <input PRG file> [<input PRG file> ...]
+
+The entry number of every input is its position on the command line.
+
+Bundle layout after the two byte load address:
+- 1 byte:               number of entries
+- 3 bytes per entry:    entry number, packed length low byte, packed length high byte
+- packed data of all entries in index order, RLE packed as TED_RLE_Pack() in ted_core.c
+*/
+
+//Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tedserle.h"
+
+#define BUNDLE_LOADADDRESS  0xAC00      // Load address, equal to SCREENMAPBASE in defines.h
+#define BUNDLE_MAXENTRIES   16          // Maximum number of entries
+#define BUNDLE_MAXSIZE      0x5000      // Maximum bundle size to fit screen map area
+
+unsigned char input[0x10000];
+unsigned char packed[BUNDLE_MAXENTRIES][0x10100];
+unsigned int packedsize[BUNDLE_MAXENTRIES];
+
+int main(int argc, char* argv[])
+{
+    FILE* file;
+    unsigned int entries = argc - 2;
+    unsigned int length, x;
+    unsigned long total;
+
+    if(argc < 3 || entries > BUNDLE_MAXENTRIES)
+    {
+        fprintf(stderr,"Usage: %s <output file> <input PRG file> [<input PRG file> ...]\n",argv[0]);
+        fprintf(stderr,"Maximum number of input files is %u.\n",BUNDLE_MAXENTRIES);
+        return 1;
+    }
+
+    // Read and pack all inputs, skipping their load address
+    total = 3 + entries*3;
+    for(x=0;x<entries;x++)
+    {
+        file = fopen(argv[x+2],"rb");
+        if(!file)
+        {
+            fprintf(stderr,"Can not open %s.\n",argv[x+2]);
+            return 1;
+        }
+        length = fread(input,1,sizeof(input),file);
+        fclose(file);
+        if(length < 3)
+        {
+            fprintf(stderr,"%s is not a valid PRG file.\n",argv[x+2]);
+            return 1;
+        }
+        packedsize[x] = rle_pack(input+2,packed[x],length-2,NULL);
+        total += packedsize[x];
+        printf("Entry %u: %s, %u bytes packed to %u bytes.\n",x,argv[x+2],length-2,packedsize[x]);
+    }
+
+    if(total > BUNDLE_MAXSIZE)
+    {
+        fprintf(stderr,"Bundle size of %lu bytes too large.\n",total);
+        return 1;
+    }
+
+    // Write bundle
+    file = fopen(argv[1],"wb");
+    if(!file)
+    {
+        fprintf(stderr,"Can not create %s.\n",argv[1]);
+        return 1;
+    }
+    fputc(BUNDLE_LOADADDRESS & 0xff,file);
+    fputc((BUNDLE_LOADADDRESS>>8) & 0xff,file);
+    fputc(entries,file);
+    for(x=0;x<entries;x++)
+    {
+        fputc(x,file);
+        fputc(packedsize[x] & 0xff,file);
+        fputc((packedsize[x]>>8) & 0xff,file);
+    }
+    for(x=0;x<entries;x++)
+    {
+        fwrite(packed[x],1,packedsize[x],file);
+    }
+    fclose(file);
+
+    printf("Created %s with %u entries, %lu bytes.\n",argv[1],entries,total);
+    return 0;
+}
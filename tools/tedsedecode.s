@@ -0,0 +1,297 @@
+; ====================================================================================
+; tedsedecode.s
+; Decoders for screens exported by TEDSE as ca65 assembly or binary data
+;
+; Include in a ca65 program with .include "tedsedecode.s", or assemble and link it
+; and import the routines. Uses 20 bytes of zero page from TEDSE_ZP, define
+; TEDSE_ZP before including to move them.
+;
+; Cycle counts of each instruction are given in [brackets], as CPU cycles of the
+; 6502 core of the TED. Branches are counted as taken or not taken like [3/2].
+; The TED takes cycles away from the CPU while drawing the screen, so blank the
+; screen or unpack during the border for the counts to match the time taken.
+;
+; Cycles for a 40x25 plane of 1000 bytes, including the RTS:
+;   tedse_copy          16522
+;   tedse_rle_unpack    13 per byte of a run, 18 per byte of a literal, 54 per run,
+;                       50 per literal: about 22900 for a plane that packs to 971 bytes
+;   tedse_tile_unpack   31546
+; Add one cycle for every indexed read and taken branch that crosses a page.
+;
+; =====================================================================================
+
+	.export		tedse_copy
+	.export		tedse_rle_unpack
+	.export		tedse_tile_unpack
+
+.ifndef TEDSE_ZP
+TEDSE_ZP		= $D0
+.endif
+
+	; Parameters
+TEDSE_SRC		= TEDSE_ZP			; Source address: data or tile map
+TEDSE_DST		= TEDSE_ZP+2		; Destination address
+TEDSE_LEN		= TEDSE_ZP+4		; tedse_copy: length in bytes
+TEDSE_TILES		= TEDSE_ZP+4		; tedse_tile_unpack: address of tile table
+TEDSE_COUNT		= TEDSE_ZP+6		; tedse_tile_unpack: number of tiles in tile table
+TEDSE_WIDTH		= TEDSE_ZP+7		; tedse_tile_unpack: width of the plane in characters, 1-255
+TEDSE_ROWS		= TEDSE_ZP+8		; tedse_tile_unpack: height of the plane in characters, 1-255
+TEDSE_PITCH		= TEDSE_ZP+9		; tedse_tile_unpack: distance between destination rows, 40 for the screen
+
+	; Work variables
+TEDSE_TR		= TEDSE_ZP+11		; Pointer to top right corners of the tiles
+TEDSE_BL		= TEDSE_ZP+13		; Pointer to bottom left corners of the tiles
+TEDSE_BR		= TEDSE_ZP+15		; Pointer to bottom right corners of the tiles
+TEDSE_TW		= TEDSE_ZP+17		; Number of tiles in a tile row
+TEDSE_LIMIT		= TEDSE_ZP+18		; Destination index at end of a row of tiles
+TEDSE_TMP		= TEDSE_ZP+19		; Destination index
+
+.segment	"CODE"
+
+; ------------------------------------------------------------------------------------------
+tedse_copy:
+; Function to copy raw exported data
+; Input:	TEDSE_SRC = source address
+;			TEDSE_DST = destination address
+;			TEDSE_LEN = length in bytes
+; Cycles:	16 per byte and 15 per page for full pages, 18 per byte of the last page, 18 fixed
+; ------------------------------------------------------------------------------------------
+
+	ldy #$00							; [2] Set index at start
+	ldx TEDSE_LEN+1						; [3] Number of full pages
+	beq copy_rest						; [3/2] Branch if no full pages
+copy_page:
+	lda (TEDSE_SRC),y					; [5] Copy byte
+	sta (TEDSE_DST),y					; [6]
+	iny									; [2] Next byte
+	bne copy_page						; [3/2] Loop until page done
+	inc TEDSE_SRC+1						; [5] Next page of source
+	inc TEDSE_DST+1						; [5] Next page of destination
+	dex									; [2] Decrease page counter
+	bne copy_page						; [3/2] Loop until all full pages done
+copy_rest:
+	ldx TEDSE_LEN						; [3] Number of bytes in last page
+	beq copy_end						; [3/2] Branch if none
+copy_restloop:
+	lda (TEDSE_SRC),y					; [5] Copy byte
+	sta (TEDSE_DST),y					; [6]
+	iny									; [2] Next byte
+	dex									; [2] Decrease counter
+	bne copy_restloop					; [3/2] Loop until done
+copy_end:
+	rts									; [6]
+
+; ------------------------------------------------------------------------------------------
+tedse_rle_unpack:
+; Function to unpack RLE exported data, same format as TED_RLE_Unpack_core in TEDSE
+; Packed format per control byte:
+;			$00-$7F = literal: copy next (value+1) bytes
+;			$80-$FE = run: repeat next byte (value-$7E) times
+;			$FF     = end of packed data
+; Input:	TEDSE_SRC = source address of packed data
+;			TEDSE_DST = destination address
+; Output:	TEDSE_SRC = address after end marker
+;			TEDSE_DST = address after last written byte
+; Cycles:	18 per literal byte plus 50 per literal,
+;			13 per run byte plus 54 per run, 26 for the end marker, 5 more when a pointer crosses a page
+; ------------------------------------------------------------------------------------------
+
+rle_loop:
+	ldy #$00							; [2] Set index to control byte
+	lda (TEDSE_SRC),y					; [5] Load control byte
+	cmp #$ff							; [2] Check for end marker
+	beq rle_end							; [3/2] Branch to end if end marker found
+	cmp #$80							; [2] Check for run or literal
+	bcs rle_run							; [3/2] Branch if run
+
+	; Literal: copy (value+1) bytes
+	tax									; [2] Set X counter at count minus 1
+	inc TEDSE_SRC						; [5] Increase source pointer past control byte
+	bne rle_litloop						; [3/2] Skip high byte if no page crossed
+	inc TEDSE_SRC+1						; [5] Increase high byte of source pointer
+rle_litloop:
+	lda (TEDSE_SRC),y					; [5] Load literal byte
+	sta (TEDSE_DST),y					; [6] Store at destination
+	iny									; [2] Increase index
+	dex									; [2] Decrease counter
+	bpl rle_litloop						; [3/2] Loop until counter past zero
+	tya									; [2] Add count to source
+	clc									; [2]
+	adc TEDSE_SRC						; [3]
+	sta TEDSE_SRC						; [3]
+	bcc rle_adddest						; [3/2]
+	inc TEDSE_SRC+1						; [5]
+	bcs rle_adddest						; [3] Always taken, add count to destination
+
+	; Run: repeat next byte (value-$7E) times
+rle_run:
+	sbc #$7f							; [2] Subtract with carry set for count minus 1
+	tax									; [2] Set X counter at count minus 1
+	iny									; [2] Set index to value byte
+	lda (TEDSE_SRC),y					; [5] Load value to repeat
+	dey									; [2] Set index to start of destination
+rle_runloop:
+	sta (TEDSE_DST),y					; [6] Store value at destination
+	iny									; [2] Increase index
+	dex									; [2] Decrease counter
+	bpl rle_runloop						; [3/2] Loop until counter past zero
+	clc									; [2] Skip control and value byte
+	lda TEDSE_SRC						; [3]
+	adc #$02							; [2]
+	sta TEDSE_SRC						; [3]
+	bcc rle_adddest						; [3/2]
+	inc TEDSE_SRC+1						; [5]
+
+rle_adddest:
+	tya									; [2] Add count to destination
+	clc									; [2]
+	adc TEDSE_DST						; [3]
+	sta TEDSE_DST						; [3]
+	bcc rle_loop						; [3/2] Next control byte
+	inc TEDSE_DST+1						; [5]
+	bcs rle_loop						; [3] Always taken, next control byte
+
+rle_end:
+	inc TEDSE_SRC						; [5] Skip end marker
+	bne rle_done						; [3/2]
+	inc TEDSE_SRC+1						; [5]
+rle_done:
+	rts									; [6]
+
+; ------------------------------------------------------------------------------------------
+tedse_tile_unpack:
+; Function to draw a tile exported plane: a map of 2x2 tile numbers, row by row,
+; and a tile table of four arrays of TEDSE_COUNT bytes: the top left, top right,
+; bottom left and bottom right characters of every tile
+; For an odd width the right half of the last tile is written too, one byte past the width on every row;
+; only with TEDSE_PITCH equal to the width is that the first byte of the next row, leaving one byte after the last row
+; Input:	TEDSE_SRC = address of tile map
+;			TEDSE_DST = destination address
+;			TEDSE_TILES = address of tile table
+;			TEDSE_COUNT = number of tiles, 0 for 256
+;			TEDSE_WIDTH = width in characters
+;			TEDSE_ROWS = height in characters
+;			TEDSE_PITCH = distance between destination rows in bytes (16 bit)
+; Output:	TEDSE_SRC = address after tile map
+; Cycles:	60 per tile and screen row, 43 per screen row, 29 per row of tiles, 122 fixed
+; ------------------------------------------------------------------------------------------
+
+	clc									; [2] Top right corners follow top left corners
+	lda TEDSE_TILES						; [3]
+	adc TEDSE_COUNT						; [3]
+	sta TEDSE_TR						; [3]
+	lda TEDSE_TILES+1					; [3]
+	adc #$00							; [2]
+	sta TEDSE_TR+1						; [3]
+	ldx TEDSE_COUNT						; [3] Add 256 for a count of 0
+	bne tile_bl							; [3/2]
+	inc TEDSE_TR+1						; [5]
+tile_bl:
+	clc									; [2] Bottom left corners follow top right corners
+	lda TEDSE_TR						; [3]
+	adc TEDSE_COUNT						; [3]
+	sta TEDSE_BL						; [3]
+	lda TEDSE_TR+1						; [3]
+	adc #$00							; [2]
+	sta TEDSE_BL+1						; [3]
+	cpx #$00							; [2] Add 256 for a count of 0
+	bne tile_br							; [3/2]
+	inc TEDSE_BL+1						; [5]
+tile_br:
+	clc									; [2] Bottom right corners follow bottom left corners
+	lda TEDSE_BL						; [3]
+	adc TEDSE_COUNT						; [3]
+	sta TEDSE_BR						; [3]
+	lda TEDSE_BL+1						; [3]
+	adc #$00							; [2]
+	sta TEDSE_BR+1						; [3]
+	cpx #$00							; [2] Add 256 for a count of 0
+	bne tile_tw							; [3/2]
+	inc TEDSE_BR+1						; [5]
+tile_tw:
+	lda TEDSE_WIDTH						; [3] Tiles per row is half the width, rounded up
+	clc									; [2]
+	adc #$01							; [2]
+	ror a								; [2]
+	sta TEDSE_TW						; [3]
+	asl a								; [2] Destination index at end of a row, 0 for 256
+	sta TEDSE_LIMIT						; [3]
+
+tile_row:
+	ldy #$00							; [2] Top halves of a row of tiles
+	sty TEDSE_TMP						; [3] Destination index
+tile_top:
+	lda TEDSE_TMP						; [3] Map index is half the destination index
+	lsr a								; [2]
+	tay									; [2]
+	lda (TEDSE_SRC),y					; [5] Load tile number
+	tay									; [2]
+	lda (TEDSE_TILES),y					; [5] Load top left character
+	tax									; [2]
+	lda (TEDSE_TR),y					; [5] Load top right character
+	ldy TEDSE_TMP						; [3] Store top right character
+	iny									; [2]
+	sta (TEDSE_DST),y					; [6]
+	dey									; [2] Store top left character
+	txa									; [2]
+	sta (TEDSE_DST),y					; [6]
+	iny									; [2] Next tile
+	iny									; [2]
+	sty TEDSE_TMP						; [3]
+	cpy TEDSE_LIMIT						; [3] Check for end of row
+	bne tile_top						; [3/2]
+	jsr tile_nextrow					; [6+26] Destination to next row
+	dec TEDSE_ROWS						; [5] Decrease row counter
+	beq tile_end						; [3/2] Branch if no bottom half for the last row
+
+	ldy #$00							; [2] Bottom halves of a row of tiles
+	sty TEDSE_TMP						; [3] Destination index
+tile_bottom:
+	lda TEDSE_TMP						; [3] Map index is half the destination index
+	lsr a								; [2]
+	tay									; [2]
+	lda (TEDSE_SRC),y					; [5] Load tile number
+	tay									; [2]
+	lda (TEDSE_BL),y					; [5] Load bottom left character
+	tax									; [2]
+	lda (TEDSE_BR),y					; [5] Load bottom right character
+	ldy TEDSE_TMP						; [3] Store bottom right character
+	iny									; [2]
+	sta (TEDSE_DST),y					; [6]
+	dey									; [2] Store bottom left character
+	txa									; [2]
+	sta (TEDSE_DST),y					; [6]
+	iny									; [2] Next tile
+	iny									; [2]
+	sty TEDSE_TMP						; [3]
+	cpy TEDSE_LIMIT						; [3] Check for end of row
+	bne tile_bottom						; [3/2]
+	jsr tile_nextrow					; [6+26] Destination to next row
+	dec TEDSE_ROWS						; [5] Decrease row counter
+	beq tile_end						; [3/2] Branch if done
+	jsr tile_nextmap					; [6+20] Map to next row of tiles
+	jmp tile_row						; [3]
+
+tile_end:
+	jsr tile_nextmap					; [6+20] Map past last row of tiles
+	rts									; [6]
+
+tile_nextrow:
+	clc									; [2] Add pitch to destination
+	lda TEDSE_DST						; [3]
+	adc TEDSE_PITCH						; [3]
+	sta TEDSE_DST						; [3]
+	lda TEDSE_DST+1						; [3]
+	adc TEDSE_PITCH+1					; [3]
+	sta TEDSE_DST+1						; [3]
+	rts									; [6]
+
+tile_nextmap:
+	clc									; [2] Add tiles per row to map
+	lda TEDSE_SRC						; [3]
+	adc TEDSE_TW						; [3]
+	sta TEDSE_SRC						; [3]
+	bcc tile_mapdone					; [3/2]
+	inc TEDSE_SRC+1						; [5]
+tile_mapdone:
+	rts									; [6]
@@ -0,0 +1,468 @@
+/*
+TED Screen Editor
+Screen map check and benchmark, runs on the build host
+Written in 2022 by Xander Mol
+
+https://github.com/xahmol/TEDScreenEdit
+https://www.idreamtin8bits.com/
+
+Builds the screen map routines of src/screenmap.c for the host, against the
+memory shim in screenmap.h, and runs them on random canvases in both layouts.
+Every result is compared with a plain model of the canvas as rows of
+characters and attributes, including the signature, the modified rows marked
+for autosave and memory outside the screen map. Then the routines are timed
+on the largest canvases that fit in memory, and on canvases that also fit in
+aligned layout.
+
+Usage: tedsemapbench [-s <seed>] [-n <rounds>] [-t]
+
+-s sets the seed for the random canvases and operations, -n the number of
+operations to check (default 2000), -t skips the checks and only times.
+The exit code is 1 if any result differs from the model.
+
+Times are of the host build, so they compare versions of an algorithm with
+each other but say little about the speed on the Plus/4.
+*/
+
+//Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "defines.h"
+#include "screenmap.h"
+
+#define MODEL_MAXWIDTH      ((MEMORYLIMIT-SCREENMAPBASE-24)/(2*25))    // Widest canvas that fits
+#define MODEL_MAXHEIGHT     ((MEMORYLIMIT-SCREENMAPBASE-24)/(2*40))    // Highest canvas that fits
+#define BENCH_MINTIME       (CLOCKS_PER_SEC/5)                         // Minimum time to run each benchmark
+#define GUARD(address)      ((unsigned char)((address)*13+((address)>>8)*7+5))
+
+// Memory shim
+unsigned char hostmemory[0x10000];
+unsigned int hostfillrows[FILLMAXROWS];
+struct FillSeed hostfillstack[FILLSTACKSIZE];
+char version[22] = "v 0.99 - host";
+
+// Model of the canvas
+unsigned char modelchars[MODEL_MAXHEIGHT][MODEL_MAXWIDTH];
+unsigned char modelattrs[MODEL_MAXHEIGHT][MODEL_MAXWIDTH];
+unsigned char savechars[MODEL_MAXHEIGHT][MODEL_MAXWIDTH];
+unsigned char saveattrs[MODEL_MAXHEIGHT][MODEL_MAXWIDTH];
+unsigned char areachars[MODEL_MAXHEIGHT][MODEL_MAXWIDTH];
+unsigned char areaattrs[MODEL_MAXHEIGHT][MODEL_MAXWIDTH];
+unsigned char modeldone[MODEL_MAXHEIGHT][MODEL_MAXWIDTH];
+struct FillSeed modelstack[MODEL_MAXWIDTH*MODEL_MAXHEIGHT];
+
+// Values of random canvases: few, so areas to flood fill are larger than a cell
+unsigned char palettechars[4] = { CH_SPACE, 0x51, 0xa0, 0x20 };
+unsigned char paletteattrs[4] = { COLOR_WHITE, 0x32, 0x71, 0x45 };
+
+unsigned long randomstate = 1;
+unsigned int failures;
+
+unsigned int random_number(unsigned int range)
+{
+    // Random number from 0 to range-1, the same on every host
+
+    randomstate = (randomstate * 1103515245UL + 12345UL) & 0x7fffffffUL;
+    return (randomstate >> 8) % range;
+}
+
+void guard_set()
+{
+    // Fill memory outside the screen map and row buffer with a pattern
+
+    unsigned int address;
+
+    for(address=0;address<0x10000;address++)
+    {
+        if(address < SCREENMAPBASE || address > MEMORYLIMIT) { hostmemory[address] = GUARD(address); }
+    }
+}
+
+void canvas_new(unsigned int width, unsigned int height, unsigned char aligned, unsigned char uniform)
+{
+    // Make a random canvas, written in packed layout as loaded from file, then set to the layout
+    // Input: width and height, aligned layout flag, uniform for a canvas of one value
+
+    unsigned int x, y;
+    unsigned char value;
+
+    guard_set();
+    screenwidth = width;
+    screenheight = height;
+    screentotal = width * height;
+    screenstride = width;
+    screenplane = screentotal + 24;
+    screenalign = 0;
+    for(y=0;y<height;y++)
+    {
+        for(x=0;x<width;x++)
+        {
+            // Blocks of 4x4 with a value, and some noise
+            value = uniform? 0 : ((x/4)*7 + (y/4)*3 + (x/4)*(y/4)) & 3;
+            if(!uniform && random_number(10)==0) { value = random_number(4); }
+            modelchars[y][x] = palettechars[value];
+            modelattrs[y][x] = paletteattrs[uniform? 0 : (value+(x/9)) & 3];
+            POKE(screenmap_packedscreenaddr(y,x,width,height),modelchars[y][x]);
+            POKE(screenmap_packedattraddr(y,x,width),modelattrs[y][x]);
+        }
+    }
+    placesignature();
+    screenalign = screenmap_setlayout(aligned);
+}
+
+void model_save()
+{
+    memcpy(savechars,modelchars,sizeof(savechars));
+    memcpy(saveattrs,modelattrs,sizeof(saveattrs));
+    memset(dirtyrows,0,DIRTYROWS_SIZE);
+}
+
+void fail(const char* operation, const char* message, unsigned int row, unsigned int col)
+{
+    fprintf(stderr,"%s: %s at row %u, column %u, canvas %ux%u %s.\n",operation,message,row,col,screenwidth,screenheight,screenalign? "aligned" : "packed");
+    failures++;
+}
+
+int canvas_check(const char* operation, int checkdirty)
+{
+    // Compare the screen map with the model
+    // Input: name of operation for messages, checkdirty to check marking of changed rows since model_save()
+    // Output: 0 if equal
+
+    unsigned int x, y, address;
+    char signature[25];
+
+    for(y=0;y<screenheight;y++)
+    {
+        for(x=0;x<screenwidth;x++)
+        {
+            if(PEEK(screenmap_screenaddr(y,x)) != modelchars[y][x]) { fail(operation,"wrong character",y,x); return 1; }
+            if(PEEK(screenmap_attraddr(y,x)) != modelattrs[y][x]) { fail(operation,"wrong attribute",y,x); return 1; }
+        }
+        if(checkdirty && !(dirtyrows[y>>3] & (1<<(y&7))) &&
+           (memcmp(savechars[y],modelchars[y],screenwidth) || memcmp(saveattrs[y],modelattrs[y],screenwidth)))
+        {
+            fail(operation,"changed row not marked",y,0);
+            return 1;
+        }
+    }
+    sprintf(signature," %s ",version);
+    if(memcmp(MEMORY(SCREENMAPBASE+screenplane-24),signature,strlen(signature))) { fail(operation,"wrong signature",0,0); return 1; }
+    for(address=0;address<0x10000;address++)
+    {
+        if(address >= SCREENMEMORY && address < SCREENMEMORY+0x0400) { continue; }
+        if((address < SCREENMAPBASE || address > MEMORYLIMIT) && hostmemory[address] != GUARD(address))
+        {
+            fprintf(stderr,"%s: memory outside screen map changed at $%04X.\n",operation,address);
+            failures++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void model_resize(unsigned int newwidth, unsigned int newheight)
+{
+    // Resize the model, new cells are white spaces
+
+    unsigned int x, y;
+
+    for(y=0;y<newheight;y++)
+    {
+        for(x=0;x<newwidth;x++)
+        {
+            if(y >= screenheight || x >= screenwidth)
+            {
+                modelchars[y][x] = CH_SPACE;
+                modelattrs[y][x] = COLOR_WHITE;
+            }
+        }
+    }
+}
+
+void model_floodfill(unsigned int x, unsigned int y, unsigned char mode, unsigned char newcode, unsigned char newattr)
+{
+    // Flood fill the model cell by cell with a stack, four directions
+
+    unsigned int sp = 0;
+    unsigned char oldcode = modelchars[y][x];
+    unsigned char oldattr = modelattrs[y][x];
+
+    memset(modeldone,0,sizeof(modeldone));
+    modelstack[sp].x = x;
+    modelstack[sp++].y = y;
+    modeldone[y][x] = 1;
+    while(sp)
+    {
+        sp--;
+        x = modelstack[sp].x;
+        y = modelstack[sp].y;
+        if(mode & FILL_SCREENCODE) { modelchars[y][x] = newcode; }
+        if(mode & FILL_ATTRIBUTE) { modelattrs[y][x] = newattr; }
+
+#define MODEL_PUSH(nx,ny) \
+        if(!modeldone[ny][nx] && (!(mode & FILL_SCREENCODE) || modelchars[ny][nx]==oldcode) && (!(mode & FILL_ATTRIBUTE) || modelattrs[ny][nx]==oldattr)) \
+        { modeldone[ny][nx] = 1; modelstack[sp].x = nx; modelstack[sp++].y = ny; }
+
+        if(x > 0)              { MODEL_PUSH(x-1,y); }
+        if(x < screenwidth-1)  { MODEL_PUSH(x+1,y); }
+        if(y > 0)              { MODEL_PUSH(x,y-1); }
+        if(y < screenheight-1) { MODEL_PUSH(x,y+1); }
+    }
+}
+
+void model_reload()
+{
+    // Take the model from the screen map, after a flood fill that ran out of span stack
+
+    unsigned int x, y;
+
+    for(y=0;y<screenheight;y++)
+    {
+        for(x=0;x<screenwidth;x++)
+        {
+            modelchars[y][x] = PEEK(screenmap_screenaddr(y,x));
+            modelattrs[y][x] = PEEK(screenmap_attraddr(y,x));
+        }
+    }
+}
+
+void random_area(unsigned int* row, unsigned int* col, unsigned int* width, unsigned int* height)
+{
+    *width = random_number(screenwidth) + 1;
+    *height = random_number(screenheight) + 1;
+    *col = random_number(screenwidth - *width + 1);
+    *row = random_number(screenheight - *height + 1);
+}
+
+unsigned int check_operation()
+{
+    // Run one random operation on the present canvas and check it against the model
+    // Output: 0 if the result is equal to the model
+
+    unsigned int row, col, width, height, destrow, destcol, x, y, size;
+    unsigned char mode, code, attr, cut;
+
+    model_save();
+    switch(random_number(9))
+    {
+    case 0:
+        screenalign = screenmap_setlayout(!screenalign);
+        return canvas_check("screenmap_setlayout",0);
+
+    case 1:
+        // Random width that fits, if any does in the present layout
+        for(x=0;x<100 && !screenmap_fits(size = 40 + random_number(MODEL_MAXWIDTH-40+1),screenheight);x++);
+        if(x==100) { return 0; }
+        model_resize(size,screenheight);
+        screenmap_resizewidth(size);
+        return canvas_check("screenmap_resizewidth",0);
+
+    case 2:
+        for(y=0;y<100 && !screenmap_fits(screenwidth,size = 25 + random_number(MODEL_MAXHEIGHT-25+1));y++);
+        if(y==100) { return 0; }
+        model_resize(screenwidth,size);
+        screenmap_resizeheight(size);
+        return canvas_check("screenmap_resizeheight",0);
+
+    case 3:
+        // Copy or cut a random area to a random place it fits, areas may overlap
+        random_area(&row,&col,&width,&height);
+        destcol = random_number(screenwidth - width + 1);
+        destrow = random_number(screenheight - height + 1);
+        cut = random_number(2);
+        for(y=0;y<height;y++)
+        {
+            memcpy(areachars[y],modelchars[row+y]+col,width);
+            memcpy(areaattrs[y],modelattrs[row+y]+col,width);
+            if(cut)
+            {
+                memset(modelchars[row+y]+col,CH_SPACE,width);
+                memset(modelattrs[row+y]+col,COLOR_WHITE,width);
+            }
+        }
+        for(y=0;y<height;y++)
+        {
+            memcpy(modelchars[destrow+y]+destcol,areachars[y],width);
+            memcpy(modelattrs[destrow+y]+destcol,areaattrs[y],width);
+        }
+        screenmap_copyarea(row,col,destrow,destcol,width,height,cut);
+        return canvas_check("screenmap_copyarea",1);
+
+    case 4:
+        random_area(&row,&col,&width,&height);
+        mode = random_number(3) + 1;
+        code = palettechars[random_number(4)];
+        attr = paletteattrs[random_number(4)];
+        for(y=0;y<height;y++)
+        {
+            if(mode & FILL_SCREENCODE) { memset(modelchars[row+y]+col,code,width); }
+            if(mode & FILL_ATTRIBUTE) { memset(modelattrs[row+y]+col,attr,width); }
+        }
+        screenmap_fillarea(row,col,width,height,code,attr,mode);
+        return canvas_check("screenmap_fillarea",1);
+
+    case 5:
+        random_area(&row,&col,&width,&height);
+        code = random_number(16);
+        for(y=0;y<height;y++)
+        {
+            for(x=0;x<width;x++)
+            {
+                modelattrs[row+y][col+x] = (modelattrs[row+y][col+x] & 0xf0) + code;
+            }
+        }
+        screenmap_paintarea(row,col,width,height,code);
+        return canvas_check("screenmap_paintarea",1);
+
+    case 6:
+        code = palettechars[random_number(4)];
+        attr = paletteattrs[random_number(4)];
+        for(y=0;y<screenheight;y++)
+        {
+            memset(modelchars[y],code,screenwidth);
+            memset(modelattrs[y],attr,screenwidth);
+        }
+        screenmapfill(code,attr);
+        return canvas_check("screenmapfill",1);
+
+    case 7:
+        // Plot one cell, on wide canvases also in columns above 255
+        x = random_number(screenwidth);
+        y = random_number(screenheight);
+        code = palettechars[random_number(4)];
+        attr = paletteattrs[random_number(4)];
+        modelchars[y][x] = code;
+        modelattrs[y][x] = attr;
+        screenmapplot(y,x,code,attr);
+        return canvas_check("screenmapplot",1);
+
+    default:
+        x = random_number(screenwidth);
+        y = random_number(screenheight);
+        mode = random_number(3) + 1;
+        code = palettechars[random_number(4)];
+        attr = paletteattrs[random_number(4)];
+        if(screenmap_fillchanges(x,y,mode,code,attr))
+        {
+            model_floodfill(x,y,mode,code,attr);
+        }
+        if(screenmap_floodfill(x,y,mode,code,attr))
+        {
+            // Span stack overflow is reported to the user, only the rest of memory can be checked
+            model_reload();
+        }
+        return canvas_check("screenmap_floodfill",1);
+    }
+}
+
+double bench_time(int operation, unsigned int width, unsigned int height, unsigned char aligned)
+{
+    // Time an operation on a canvas, repeated until BENCH_MINTIME
+    // Input: operation number, canvas size and layout
+    // Output: microseconds per call
+
+    unsigned long calls = 0;
+    clock_t start;
+
+    // Every operation leaves a canvas of the same size to repeat on, the flood fill
+    // alternates between two values so each call fills the whole uniform canvas
+    canvas_new(width,height,aligned,operation==6);
+    start = clock();
+    while(clock() - start < BENCH_MINTIME)
+    {
+        switch(operation)
+        {
+        case 0:
+            screenmap_setlayout(!aligned);
+            screenmap_setlayout(aligned);
+            break;
+        case 1:
+            screenmap_resizewidth(width-1);
+            screenmap_resizewidth(width);
+            break;
+        case 2:
+            screenmap_resizeheight(height-1);
+            screenmap_resizeheight(height);
+            break;
+        case 3:
+            screenmap_copyarea(0,0,1,1,width-1,height-1,1);
+            break;
+        case 4:
+            screenmap_fillarea(0,0,width,height,CH_SPACE,COLOR_WHITE,FILL_SCREENCODE | FILL_ATTRIBUTE);
+            break;
+        case 5:
+            screenmap_paintarea(0,0,width,height,2);
+            break;
+        default:
+            if(calls & 1) { screenmap_floodfill(width/2,height/2,FILL_SCREENCODE | FILL_ATTRIBUTE,CH_SPACE,COLOR_WHITE); }
+            else { screenmap_floodfill(width/2,height/2,FILL_SCREENCODE | FILL_ATTRIBUTE,0x51,0x32); }
+            break;
+        }
+        calls++;
+    }
+    return (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC / calls;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* operations[] = {
+        "setlayout and back", "resizewidth -1 and back", "resizeheight -1 and back",
+        "copyarea cut all-1 by 1,1", "fillarea all", "paintarea all", "floodfill all" };
+    unsigned int sizes[4][2] = { { MODEL_MAXWIDTH, 25 }, { 40, MODEL_MAXHEIGHT }, { 256, 32 }, { 64, 150 } };
+    unsigned long rounds = 2000, round;
+    int arg, timeonly = 0;
+    unsigned int x, size, aligned;
+
+    // Options
+    for(arg=1;arg<argc;arg++)
+    {
+        if(!strcmp(argv[arg],"-s") && arg+1<argc) { randomstate = strtoul(argv[++arg],NULL,10); }
+        else if(!strcmp(argv[arg],"-n") && arg+1<argc) { rounds = strtoul(argv[++arg],NULL,10); }
+        else if(!strcmp(argv[arg],"-t")) { timeonly = 1; }
+        else
+        {
+            fprintf(stderr,"Usage: %s [-s <seed>] [-n <rounds>] [-t]\n",argv[0]);
+            return 1;
+        }
+    }
+
+    // Check random operations, on a new random canvas every 50 operations
+    if(!timeonly)
+    {
+        for(round=0;round<rounds && !failures;round++)
+        {
+            if(round % 50 == 0)
+            {
+                do
+                {
+                    x = 40 + random_number(MODEL_MAXWIDTH-40+1);
+                    size = 25 + random_number(MODEL_MAXHEIGHT-25+1);
+                } while((unsigned long)x*size*2 + 24 > MEMORYLIMIT-SCREENMAPBASE);
+                canvas_new(x,size,random_number(2),0);
+                if(canvas_check("canvas_new",0)) { break; }
+            }
+            check_operation();
+        }
+        if(failures) { return 1; }
+        printf("%lu operations equal to model.\n",rounds);
+    }
+
+    // Time operations on the largest canvases
+    printf("%-28s %9s %8s %12s\n","Operation","Canvas","Layout","Microseconds");
+    for(x=0;x<sizeof(operations)/sizeof(operations[0]);x++)
+    {
+        for(size=0;size<4;size++)
+        {
+            for(aligned=0;aligned<2;aligned++)
+            {
+                if(aligned && screenmap_alignedsize(sizes[size][0],sizes[size][1]) > MEMORYLIMIT-SCREENMAPBASE) { continue; }
+                printf("%-28s %5ux%-3u %8s %12.1f\n",operations[x],sizes[size][0],sizes[size][1],aligned? "aligned" : "packed",
+                    bench_time(x,sizes[size][0],sizes[size][1],aligned));
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+TED Screen Editor
+RLE packer shared by the tools that run on the build host, see tedserle.h for the format
+Written in 2022 by Xander Mol
+
+https://github.com/xahmol/TEDScreenEdit
+https://www.idreamtin8bits.com/
+*/
+
+#include <string.h>
+#include "tedserle.h"
+
+unsigned int rle_pack(const unsigned char* source, unsigned char* dst, unsigned int length, unsigned int* gap)
+{
+    // Pack data in one piece, as TED_RLE_Pack() and pack_payload() in prggenerator.c
+    // Also finds the largest distance the unpacked data runs ahead of the packed data, needed to unpack in place
+    // Input: source and destination buffers, unpacked length in bytes, pointer for the distance or NULL.
+    //        Destination should have room for length+length/RLE_MAXCOUNT+2 bytes
+    // Output: packed length in bytes including end marker
+
+    const unsigned char* src = source;
+    const unsigned char* end = src + length;
+    const unsigned char* literal;
+    unsigned char* start = dst;
+    unsigned int count;
+    unsigned int distance = 0;
+
+    while(src < end)
+    {
+        // Count number of equal bytes
+        count = 1;
+        while(src+count < end && count < RLE_MAXCOUNT && src[count] == *src) { count++; }
+
+        if(count > 2)
+        {
+            // Store run
+            *dst++ = count + 0x7e;
+            *dst++ = *src;
+            src += count;
+        }
+        else
+        {
+            // Store literal until next run of three equal bytes
+            literal = src;
+            count = 0;
+            do
+            {
+                src++;
+                count++;
+            } while(src < end && count < RLE_MAXCOUNT && (src+2 >= end || src[0] != src[1] || src[0] != src[2]));
+            *dst++ = count - 1;
+            memcpy(dst,literal,count);
+            dst += count;
+        }
+
+        // Track distance of unpacked data ahead of packed data after this control byte
+        if((unsigned int)(src - source) > (unsigned int)(dst - start) + distance) { distance = (src - source) - (dst - start); }
+    }
+    *dst++ = RLE_END;
+    if(length > (unsigned int)(dst - start) + distance) { distance = length - (dst - start); }
+
+    if(gap) { *gap = distance; }
+    return dst - start;
+}
+
+unsigned int rle_pack_blocks(const unsigned char* src, unsigned char* dst, unsigned int length)
+{
+    // Pack data in blocks of RLE_STREAMBLOCK bytes with one end marker, as TED_RLE_Write() and export_rle() in main.c
+    // Input: source and destination buffers, unpacked length in bytes.
+    //        Destination should have room for length+2*(length/RLE_STREAMBLOCK)+3 bytes
+    // Output: packed length in bytes including end marker
+
+    unsigned char* start = dst;
+    unsigned int chunk;
+
+    while(length)
+    {
+        chunk = (length > RLE_STREAMBLOCK)? RLE_STREAMBLOCK : length;
+        dst += rle_pack(src,dst,chunk,NULL) - 1;
+        src += chunk;
+        length -= chunk;
+    }
+    *dst++ = RLE_END;
+
+    return dst - start;
+}
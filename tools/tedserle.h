@@ -0,0 +1,31 @@
+/*
+TED Screen Editor
+RLE packer shared by the tools that run on the build host
+Written in 2022 by Xander Mol
+
+https://github.com/xahmol/TEDScreenEdit
+https://www.idreamtin8bits.com/
+
+Host version of TED_RLE_Pack() in ted_core.c, see TED_RLE_Unpack_core for the packed format:
+- 0x00-0x7f:    literal of control byte+1 bytes following
+- 0x80-0xfe:    run of control byte-0x7e times the byte following
+- 0xff:         end of packed data
+
+The output depends on where the input is split: packing in blocks, as TED_RLE_Write()
+and the data export of the editor do, ends literals and runs at every block boundary.
+Both unpack the same with TED_RLE_Unpack_core and tedse_rle_unpack in tedsedecode.s.
+*/
+
+#ifndef __TEDSERLE_H_
+#define __TEDSERLE_H_
+
+#ifndef RLE_END
+#define RLE_END             0xff        // End of packed data marker
+#define RLE_MAXCOUNT        128         // Maximum length of a literal or a run
+#define RLE_STREAMBLOCK     256         // Block size for packing to and unpacking from files
+#endif
+
+unsigned int rle_pack(const unsigned char* source, unsigned char* dst, unsigned int length, unsigned int* gap);
+unsigned int rle_pack_blocks(const unsigned char* src, unsigned char* dst, unsigned int length);
+
+#endif